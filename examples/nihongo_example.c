@@ -0,0 +1,77 @@
+/*
+ * Calls every group of the libnihongo C API : the random stream, the questions,
+ * the renderers, a lexicon and the answer checks. Exits with a failure on a wrong result.
+ */
+
+#include "nihongo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char DICTIONARY[] =
+	"\xe4\xbc\x9a\xe3\x81\x86\t\t; \xe3\x81\x82\xe3\x81\x86\t\t\t; to meet\n"
+	"\xe7\xa7\x8b\t\t; \xe3\x81\x82\xe3\x81\x8d\t\t\t; autumn\n";
+
+static int failures = 0;
+
+static void expect(const int condition, const char* what) {
+	if(!condition) {
+		fprintf(stderr, "Failed : %s\n", what);
+		++failures;
+	}
+}
+
+int main(void) {
+	expect(nns_api_version() == NNS_API_VERSION, "api version");
+
+	nns_rng rng;
+	nns_rng_seed(&rng, 42u);
+	expect(nns_rng_below(&rng, 10u) < 10u, "rng below");
+
+	uint64_t value = 0;
+	unsigned width = 0;
+	expect(nns_generate_number(&rng, 4u, 4u, &value, &width) == NNS_OK, "generate number");
+	expect(width == 4u && value >= 1000u && value <= 9999u, "number width");
+	expect(nns_generate_number(NULL, 1u, 2u, &value, &width) == NNS_ERROR_ARGUMENT, "generate without rng");
+
+	unsigned hours = 0;
+	unsigned minutes = 0;
+	expect(nns_generate_time(&rng, &hours, &minutes) == NNS_OK && hours < 24u && minutes < 60u, "generate time");
+
+	char buf[256];
+	size_t len = 0;
+	expect(nns_render_number(1200u, 4u, NNS_READING_NUMBER, NNS_SCRIPT_KANJI, buf, sizeof(buf), &len) == NNS_OK, "render kanji");
+	expect(len == 9u && memcmp(buf, "\xe5\x8d\x83\xe4\xba\x8c\xe7\x99\xbe", 9u) == 0, "render 1200 as 千二百");
+	expect(nns_render_number(1200u, 4u, NNS_READING_NUMBER, NNS_SCRIPT_KANA, buf, 1u, &len) == NNS_ERROR_SPACE, "render into a small buffer");
+	expect(nns_render_time(hours, minutes, NNS_SCRIPT_ARABIC, buf, sizeof(buf), &len) == NNS_OK, "render time");
+
+	expect(nns_check_number(1200u, 4u, NNS_READING_NUMBER, NNS_ANSWER_ARABIC, "1 200", 5u) == 1, "check arabic");
+	expect(nns_check_number(1200u, 4u, NNS_READING_NUMBER, NNS_ANSWER_ROMAJI, "sennihyaku", 10u) == 1, "check romaji");
+	expect(nns_check_number(1200u, 4u, NNS_READING_NUMBER, NNS_ANSWER_ARABIC, "1300", 4u) == 0, "check a wrong answer");
+	expect(nns_check_time(hours, minutes, NNS_ANSWER_ARABIC, buf, len) == 1, "check time");
+	expect(nns_romaji_to_kana("aki", 3u, buf, sizeof(buf), &len) == NNS_OK && len == 6u, "romaji");
+
+	nns_lexicon* lex = nns_lexicon_create();
+	expect(lex != NULL, "lexicon create");
+	if(lex != NULL) {
+		expect(nns_lexicon_add(lex, DICTIONARY, sizeof(DICTIONARY) - 1u, "n5") == NNS_OK, "lexicon add");
+		expect(nns_lexicon_size(lex) == 2u, "lexicon size");
+
+		uint32_t idx[4];
+		const int64_t selected = nns_lexicon_select(lex, "n5", idx, 4u);
+		expect(selected == 2, "lexicon select");
+
+		nns_word word;
+		expect(nns_lexicon_word(lex, idx[0], &word) == NNS_OK && word.meaning_len > 0, "lexicon word");
+		expect(nns_check_meaning(lex, idx[0], word.meaning, word.meaning_len, 0.0) == 1, "check meaning");
+		expect(nns_check_meaning(lex, idx[0], "nothing alike", 13u, 0.0) == 0, "check a wrong meaning");
+		nns_lexicon_destroy(lex);
+	}
+
+	if(failures > 0) {
+		return EXIT_FAILURE;
+	}
+	printf("libnihongo %d : all the calls are right.\n", nns_api_version());
+	return EXIT_SUCCESS;
+}
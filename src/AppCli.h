@@ -3,11 +3,14 @@
 #include "FieldReader.h"
 #include "FieldWriter.h"
 
+#include <array>
 #include <cassert>
+#include <cctype>
 #include <set>
 #include <map>
 #include <cstdio>
 #include <cstring>
+#include <string_view>
 #include <getopt.h>
 
 struct OptionBase {
@@ -25,7 +28,7 @@ struct OptionBase {
 
 	virtual ~OptionBase() = default;
 
-	bool parse(const char* arg) {
+	bool parse(const std::string_view& arg) {
 		has_user_value = parse_impl(arg);
 		return has_user_value;
 	}
@@ -34,7 +37,7 @@ struct OptionBase {
 		return has_default_value || has_user_value;
 	}
 
-	virtual bool parse_impl(const char* arg) = 0;
+	virtual bool parse_impl(const std::string_view& arg) = 0;
 	virtual void print(FILE* out) = 0;
 
 };
@@ -51,7 +54,7 @@ struct Option : public OptionBase {
 	Option(const char _name, std::string _desc, const unsigned _print_priority, T _def_value) :
 		Base_t(true, true, _name,  std::move(_desc), _print_priority), value_def(std::move(_def_value)) {}
 
-	bool parse_impl(const char* arg) override {
+	bool parse_impl(const std::string_view& arg) override {
 		return FieldReader::read(value_user, arg);
 	}
 
@@ -80,7 +83,7 @@ struct OptionFlag : public OptionBase {
 
 	OptionFlag(const char _name, std::string _desc, const unsigned _print_priority) : Base_t(false, false, _name,  std::move(_desc), _print_priority) {}
 
-	bool parse_impl(const char* arg) override { return true; }
+	bool parse_impl(const std::string_view&) override { return true; }
 	void print(FILE* out) final { fprintf(out, "\t -%c %s\n", name, desc.c_str()); }
 };
 
@@ -142,7 +145,9 @@ class AppCliBasic {
 
 protected:
 
-	std::map<char, OptionBase*> _opt_map;
+	static constexpr size_t OPT_TABLE_SIZE = 256u;
+
+	std::array<OptionBase*, OPT_TABLE_SIZE> _opt_table{};
 	std::string _opt_names;
 
 	virtual bool post_validate() const = 0;
@@ -152,28 +157,37 @@ public:
 
 	void finalize() {
 		_opt_names.clear();
-		_opt_map.clear();
+		_opt_table.fill(nullptr);
 		build_option_map();
 
-		for(const auto& item : _opt_map) {
-			_opt_names.push_back(item.first);
-			if(item.second->has_argument) {
-				_opt_names.push_back(':');
+		for(size_t i = 0; i < OPT_TABLE_SIZE; ++i) {
+			if(_opt_table[i] != nullptr) {
+				_opt_names.push_back(static_cast<char>(i));
+				if(_opt_table[i]->has_argument) {
+					_opt_names.push_back(':');
+				}
 			}
 		}
 	}
 
 	bool parse_args(int argc, char** argv) {
+		return parse_argv(argc, argv) && post_validate();
+	}
+
+	/**
+	 * Parses the command line without the validation.
+	 */
+	bool parse_argv(int argc, char** argv) {
 		bool result = true;
 		int opt;
 
 		while((opt = getopt(argc, argv, _opt_names.c_str())) != EOF) {
 			const char opt_char = static_cast<char>(opt);
-			const auto it = _opt_map.find(opt_char);
+			OptionBase* const option = find_option(opt_char);
 			bool opt_parse_reault = false;
 
-			if(it != _opt_map.end()) {
-				opt_parse_reault = it->second->has_argument ? it->second->parse(optarg) : it->second->parse(nullptr);
+			if(option != nullptr) {
+				opt_parse_reault = option->has_argument ? option->parse(optarg) : option->parse({});
 			} else {
 				fprintf(stderr,"Unknown option '%c'\n", opt_char);
 			}
@@ -185,28 +199,83 @@ public:
 			result = result && opt_parse_reault;
 		}
 
-		return result && post_validate();
+		return result;
+	}
+
+	/**
+	 * Parses options in the command line syntax, e.g. "-M numbers -r 50 -jK".
+	 * Options already set by the user are kept.
+	 */
+	bool parse_options(const std::string_view& str) {
+		bool result = true;
+		size_t pos = 0;
+		std::string_view token;
+
+		while(result && next_token(str, pos, token)) {
+			if(token.size() < 2u || token[0] != '-') {
+				fprintf(stderr,"Unexpected '%.*s'\n", int(token.size()), token.data());
+				result = false;
+				break;
+			}
+
+			for(size_t i = 1; i < token.size() && result; ++i) {
+				const char opt_char = token[i];
+				OptionBase* const option = find_option(opt_char);
+				if(option == nullptr) {
+					fprintf(stderr,"Unknown option '%c'\n", opt_char);
+					result = false;
+					break;
+				}
+
+				std::string_view arg;
+				if(option->has_argument) {
+					if(i + 1u < token.size()) {
+						arg = token.substr(i + 1u);
+					} else if(not next_token(str, pos, arg)) {
+						fprintf(stderr,"Option '%c' requires an argument.\n", opt_char);
+						result = false;
+						break;
+					}
+					i = token.size();
+				}
+
+				if(not option->has_user_value) {
+					result = option->parse(arg);
+					if(not result) {
+						fprintf(stderr,"Option '%c' parsing failure.\n", opt_char);
+					}
+				}
+			}
+		}
+
+		return result;
+	}
+
+	bool validate_args() const {
+		return post_validate();
 	}
 
 	std::string options_string() const {
 		std::string result;
 		result.push_back('-');
-		for(const auto& item : _opt_map) {
-			result.push_back(item.first);
+		for(size_t i = 0; i < OPT_TABLE_SIZE; ++i) {
+			if(_opt_table[i] != nullptr) {
+				result.push_back(static_cast<char>(i));
+			}
 		}
 		return result;
 	}
 
 	void print_options(FILE* out) {
-		if(not _opt_map.empty()) {
-			std::map<unsigned, OptionBase*> print_map;
-			for(const auto& item : _opt_map) {
-				print_map.emplace(item.second->print_priority, item.second);
+		std::map<unsigned, OptionBase*> print_map;
+		for(OptionBase* option : _opt_table) {
+			if(option != nullptr) {
+				print_map.emplace(option->print_priority, option);
 			}
+		}
 
-			for(const auto& item : print_map) {
-				item.second->print(out);
-			}
+		for(const auto& item : print_map) {
+			item.second->print(out);
 		}
 	}
 
@@ -220,6 +289,31 @@ protected:
 		fprintf(out, "\n");
 	}
 
+	OptionBase* find_option(const char name) const {
+		return _opt_table[static_cast<unsigned char>(name)];
+	}
+
+	void add_option(OptionBase* option) {
+		OptionBase*& slot = _opt_table[static_cast<unsigned char>(option->name)];
+		if(slot != nullptr && slot != option) {
+			fprintf(stderr,"Option name '%c' is duplicated.\n", option->name);
+			assert(false);
+		}
+		slot = option;
+	}
+
+	static bool next_token(const std::string_view& str, size_t& pos, std::string_view& token) {
+		while(pos < str.size() && isspace(static_cast<unsigned char>(str[pos]))) {
+			++pos;
+		}
+		const size_t begin = pos;
+		while(pos < str.size() && (not isspace(static_cast<unsigned char>(str[pos])))) {
+			++pos;
+		}
+		token = str.substr(begin, pos - begin);
+		return not token.empty();
+	}
+
 	bool validate_method(const Method& meth) const {
 		bool result = true;
 		for(const auto& item : meth.options) {
@@ -244,13 +338,7 @@ public:
 
 	void build_option_map() final {
 		for(const auto& item : _default.options) {
-			const char name = item.opt->name;
-			const auto it = _opt_map.find(name);
-			if(it != _opt_map.end() && it->second != item.opt) {
-				fprintf(stderr,"Option name '%c' is duplicated.\n", name);
-				assert(false);
-			}
-			_opt_map.emplace(name, item.opt);
+			add_option(item.opt);
 		}
 	}
 
@@ -297,7 +385,7 @@ struct AppCliMethod : AppCliBasic {
 	}
 
 	void build_option_map() final {
-		_opt_map.emplace(METHOD_NAME, &_method_opt);
+		add_option(&_method_opt);
 
 		for(size_t i = 0; i < EF::size(); ++i) {
 			if(_methods[i]._desc.empty()) {
@@ -305,13 +393,7 @@ struct AppCliMethod : AppCliBasic {
 				assert(false);
 			}
 			for(const auto& item : _methods[i].options) {
-				const char name = item.opt->name;
-				const auto it = _opt_map.find(name);
-				if(it != _opt_map.end() && it->second != item.opt) {
-					fprintf(stderr,"Option name '%c' is duplicated.\n", name);
-					assert(false);
-				}
-				_opt_map.emplace(name, item.opt);
+				add_option(item.opt);
 			}
 		}
 
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+
+/**
+ * Block buffered flashcard writer, one card per line.
+ *
+ * CSV   : RFC 4180, a field with a comma, a quote or a line break is quoted, the quotes are doubled.
+ * TSV   : tabs and line breaks are not allowed in a field, they are replaced with spaces.
+ * ANKI  : tab separated with the Anki file headers, the fields are quoted as in CSV.
+ */
+class CardWriter {
+public:
+
+	enum class Format : unsigned {
+		CSV,
+		TSV,
+		ANKI
+	};
+
+	static constexpr size_t BLOCK_SIZE = 1u << 20u;
+
+private:
+
+	FILE* const _out;
+	const Format _format;
+	const char _separator;
+	std::unique_ptr<char[]> _block;
+	size_t _size = 0;
+	size_t _fields = 0;
+	uint64_t _cards = 0;
+	uint64_t _bytes = 0;
+	bool _ok = true;
+
+public:
+
+	CardWriter(FILE* out, const Format format) :
+		_out(out),
+		_format(format),
+		_separator(format == Format::CSV ? ',' : '\t'),
+		_block(new char[BLOCK_SIZE]) {
+		setvbuf(_out, nullptr, _IONBF, 0);
+	}
+
+	CardWriter(const CardWriter&) = delete;
+	CardWriter& operator=(const CardWriter&) = delete;
+
+	~CardWriter() {
+		flush();
+	}
+
+	/**
+	 * Writes the names of the columns, must be called before the first card.
+	 */
+	void header(const std::initializer_list<std::string_view>& columns) {
+		if(_format == Format::ANKI) {
+			append("#separator:tab\n#html:false\n#columns:");
+		}
+		for(const auto& column : columns) {
+			field(column);
+		}
+		end_line();
+	}
+
+	void card(const std::string_view& front, const std::string_view& reading, const std::string_view& back) {
+		field(front);
+		field(reading);
+		field(back);
+		end_line();
+		++_cards;
+	}
+
+	/**
+	 * Writes the buffered block out.
+	 * @return false if any write has failed.
+	 */
+	bool flush() {
+		if(_size > 0) {
+			write(_block.get(), _size);
+			_size = 0;
+		}
+		return _ok;
+	}
+
+	uint64_t cards() const {
+		return _cards;
+	}
+
+	uint64_t bytes() const {
+		return _bytes + _size;
+	}
+
+private:
+
+	void field(const std::string_view& value) {
+		if(_fields++ > 0) {
+			append(_separator);
+		}
+
+		switch(_format) {
+			case Format::TSV:
+				for(const char ch : value) {
+					append((ch == '\t' || ch == '\n' || ch == '\r') ? ' ' : ch);
+				}
+				break;
+
+			default:
+				if(needs_quotes(value)) {
+					append('"');
+					for(const char ch : value) {
+						if(ch == '"') {
+							append('"');
+						}
+						append(ch);
+					}
+					append('"');
+				} else {
+					append(value);
+				}
+				break;
+		}
+	}
+
+	void end_line() {
+		append('\n');
+		_fields = 0;
+	}
+
+	bool needs_quotes(const std::string_view& value) const {
+		for(const char ch : value) {
+			if(ch == _separator || ch == '"' || ch == '\n' || ch == '\r') {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void append(const char ch) {
+		if(_size == BLOCK_SIZE) {
+			flush();
+		}
+		_block[_size++] = ch;
+	}
+
+	void append(const std::string_view& str) {
+		if(str.size() > BLOCK_SIZE - _size) {
+			flush();
+			if(str.size() >= BLOCK_SIZE) {
+				write(str.data(), str.size());
+				return;
+			}
+		}
+		memcpy(_block.get() + _size, str.data(), str.size());
+		_size += str.size();
+	}
+
+	void write(const char* data, const size_t size) {
+		if(fwrite(data, 1, size, _out) != size) {
+			_ok = false;
+		}
+		_bytes += size;
+	}
+
+};
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+/**
+ * The state of a session in a small file, an interrupted session resumes with the same questions.
+ *
+ * The state is published into one of two images in memory while the other one stays intact,
+ * so the handler of SIGINT, SIGTERM and SIGHUP always finds a complete image to save.
+ * The file is written aside, synced and renamed by async-signal-safe calls only,
+ * a reader never sees a partial one. The directory is synced after the rename so it survives a power loss.
+ */
+class Checkpoint {
+public:
+
+	struct State {
+		// The random stream before the pending question.
+		uint64_t rng;
+		uint32_t rounds_done;
+		uint32_t mistakes;
+		uint64_t elapsed_ms;
+	};
+
+private:
+
+	static constexpr uint64_t MAGIC = 0x3154504b43534e4eull; // "NNSCKPT1"
+	static constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+	static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+	static constexpr int SIGNALS[] = {SIGINT, SIGTERM, SIGHUP};
+
+	struct Image {
+		uint64_t magic;
+		uint64_t fingerprint;
+		State state;
+		uint64_t checksum;
+	};
+
+	static_assert(sizeof(Image) == 48u, "Image must be 48 bytes.");
+
+	std::string _path;
+	std::string _tmp;
+	std::string _dir;
+	uint64_t _fingerprint = 0;
+	Image _images[2]{};
+	std::atomic<unsigned> _published{0};
+	bool _resumed = false;
+	State _restored{};
+	std::string _error;
+
+public:
+
+	Checkpoint() = default;
+	Checkpoint(const Checkpoint&) = delete;
+	Checkpoint& operator=(const Checkpoint&) = delete;
+
+	~Checkpoint() {
+		close();
+	}
+
+	/**
+	 * @return The fingerprint of a drill, the state of another drill is not resumed.
+	 */
+	static uint64_t fingerprint(const std::string_view& drill) {
+		return hash(drill.data(), drill.size());
+	}
+
+	/**
+	 * Restores the state if the file exists, then saves it on the signals.
+	 */
+	bool open(const std::string& path, const uint64_t fingerprint) {
+		close();
+		_path = path;
+		_tmp = path + ".tmp";
+		const size_t slash = path.rfind('/');
+		_dir = slash == std::string::npos ? std::string(".") : path.substr(0, std::max<size_t>(slash, 1u));
+		_fingerprint = fingerprint;
+		_resumed = false;
+
+		const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if(fd >= 0) {
+			Image image{};
+			const ssize_t size = read(fd, &image, sizeof(image));
+			::close(fd);
+			if(size != ssize_t(sizeof(image)) || image.magic != MAGIC || image.checksum != checksum(image)) {
+				return fail("not a checkpoint file");
+			}
+			if(image.fingerprint != fingerprint) {
+				return fail("the checkpoint is of another drill");
+			}
+			_restored = image.state;
+			_resumed = true;
+		} else if(errno != ENOENT) {
+			return fail(strerror(errno));
+		}
+
+		instance().store(this);
+		struct sigaction action{};
+		action.sa_handler = on_signal;
+		sigemptyset(&action.sa_mask);
+		action.sa_flags = SA_RESETHAND;
+		for(const int sig : SIGNALS) {
+			sigaction(sig, &action, nullptr);
+		}
+		return true;
+	}
+
+	void close() {
+		if(instance().load() != this) {
+			return;
+		}
+		for(const int sig : SIGNALS) {
+			signal(sig, SIG_DFL);
+		}
+		instance().store(nullptr);
+	}
+
+	bool resumed() const {
+		return _resumed;
+	}
+
+	const State& restored() const {
+		return _restored;
+	}
+
+	/**
+	 * Publishes the state for the signals, cheap enough for every round.
+	 */
+	void update(const State& state) {
+		const unsigned next = 1u - _published.load(std::memory_order_relaxed);
+		_images[next] = Image{MAGIC, _fingerprint, state, 0};
+		_images[next].checksum = checksum(_images[next]);
+		_published.store(next, std::memory_order_release);
+	}
+
+	/**
+	 * Writes the published state.
+	 */
+	bool save() {
+		return write_published() || fail(strerror(errno));
+	}
+
+	/**
+	 * The session is over, there is nothing to resume.
+	 */
+	void remove() {
+		unlink(_path.c_str());
+	}
+
+	const std::string& error() const {
+		return _error;
+	}
+
+private:
+
+	static std::atomic<Checkpoint*>& instance() {
+		static std::atomic<Checkpoint*> checkpoint{nullptr};
+		return checkpoint;
+	}
+
+	/**
+	 * Saves the state, then the signal takes its default action.
+	 */
+	static void on_signal(const int sig) {
+		const int saved_errno = errno;
+		const Checkpoint* checkpoint = instance().load();
+		if(checkpoint != nullptr) {
+			checkpoint->write_published();
+		}
+		errno = saved_errno;
+		raise(sig);
+	}
+
+	/**
+	 * Async-signal-safe. An image torn by a concurrent update fails its checksum, the other one is taken.
+	 */
+	bool write_published() const {
+		const unsigned published = _published.load(std::memory_order_acquire);
+		Image image = _images[published];
+		if(image.checksum != checksum(image)) {
+			image = _images[1u - published];
+		}
+		if(image.magic != MAGIC) {
+			// Nothing is published yet.
+			return true;
+		}
+
+		const int fd = ::open(_tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if(fd < 0) {
+			return false;
+		}
+		bool result = write(fd, &image, sizeof(image)) == ssize_t(sizeof(image));
+		result = fsync(fd) == 0 && result;
+		result = ::close(fd) == 0 && result;
+		if(not result || rename(_tmp.c_str(), _path.c_str()) != 0) {
+			return false;
+		}
+
+		const int dir = ::open(_dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if(dir < 0) {
+			return false;
+		}
+		result = fsync(dir) == 0;
+		return ::close(dir) == 0 && result;
+	}
+
+	static uint64_t checksum(const Image& image) {
+		return hash(&image, offsetof(Image, checksum));
+	}
+
+	static uint64_t hash(const void* data, const size_t size) {
+		uint64_t result = FNV_OFFSET;
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		for(size_t i = 0; i < size; ++i) {
+			result ^= bytes[i];
+			result *= FNV_PRIME;
+		}
+		return result;
+	}
+
+	bool fail(const std::string& error) {
+		_error = error;
+		return false;
+	}
+
+};
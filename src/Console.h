@@ -0,0 +1,208 @@
+#pragma once
+
+#include <poll.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+/**
+ * The user side of a session : text output, line input, audio and the clock.
+ */
+class Console {
+public:
+
+	enum class Answer {
+		LINE,
+		TIMEOUT,
+		OVER
+	};
+
+	static constexpr uint64_t NO_TIMEOUT = UINT64_MAX;
+
+	virtual ~Console() = default;
+
+	virtual void write(const char* data, size_t len) = 0;
+
+	virtual void flush() = 0;
+
+	/**
+	 * Reads a line without the trailing '\n'.
+	 * @return false if the input is over.
+	 */
+	virtual bool read_line(std::string& line) = 0;
+
+	/**
+	 * Reads a line within @timeout_us microseconds, @response_us gets the time the line took.
+	 * A console without a real user answers at once.
+	 */
+	virtual Answer read_answer(std::string& line, const uint64_t timeout_us, uint64_t& response_us) {
+		(void)timeout_us;
+		response_us = 0;
+		return read_line(line) ? Answer::LINE : Answer::OVER;
+	}
+
+	/**
+	 * @return false if the audio can not be played.
+	 */
+	virtual bool say(const std::string& to_say) = 0;
+
+	/**
+	 * @return Milliseconds since an arbitrary point in the past.
+	 */
+	virtual uint64_t clock_ms() = 0;
+
+	/**
+	 * Called once per round with the expected answer.
+	 */
+	virtual void question(const std::string& /*reference*/) {}
+
+	void print(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+		char buf[256];
+		va_list args;
+		va_start(args, fmt);
+		const int len = vsnprintf(buf, sizeof(buf), fmt, args);
+		va_end(args);
+
+		if(len < 0) {
+			return;
+		}
+
+		if(size_t(len) < sizeof(buf)) {
+			write(buf, size_t(len));
+		} else {
+			std::string big(size_t(len) + 1u, '\0');
+			va_start(args, fmt);
+			vsnprintf(big.data(), big.size(), fmt, args);
+			va_end(args);
+			write(big.data(), size_t(len));
+		}
+	}
+
+};
+
+/**
+ * A console over the standard streams.
+ *
+ * The input is read from the descriptor into an own buffer rather than by stdio, so a deadline
+ * is waited by ppoll() with the resolution of the clock and no line is hidden in a stdio buffer.
+ */
+class StdConsole : public Console {
+	FILE* _in;
+	FILE* _out;
+	std::string _buffer;
+	bool _eof = false;
+
+public:
+
+	StdConsole(FILE* in, FILE* out) : _in(in), _out(out) {}
+
+	/**
+	 * Sets the timer slack of the calling thread to the least, so a deadline wakes it up within
+	 * microseconds rather than the default 50 us. Only on Linux, elsewhere it does nothing.
+	 */
+	static void tighten_timer_slack() {
+#ifdef __linux__
+		prctl(PR_SET_TIMERSLACK, 1ul);
+#endif
+	}
+
+	void write(const char* data, size_t len) override {
+		fwrite(data, 1, len, _out);
+	}
+
+	void flush() override {
+		fflush(_out);
+	}
+
+	bool read_line(std::string& line) override {
+		uint64_t response_us = 0;
+		return read_answer(line, NO_TIMEOUT, response_us) == Answer::LINE;
+	}
+
+	/**
+	 * The response is timed when the end of the line arrives, a line typed ahead takes no time.
+	 */
+	Answer read_answer(std::string& line, const uint64_t timeout_us, uint64_t& response_us) override {
+		const uint64_t tm_begin = now_us();
+		const uint64_t deadline = timeout_us == NO_TIMEOUT ? NO_TIMEOUT : tm_begin + timeout_us;
+		uint64_t tm_ready = tm_begin;
+		line.clear();
+
+		while(true) {
+			const size_t eol = _buffer.find('\n');
+			if(eol != std::string::npos || (_eof && not _buffer.empty())) {
+				const size_t len = eol != std::string::npos ? eol : _buffer.size();
+				line.assign(_buffer, 0, len);
+				_buffer.erase(0, std::min(len + 1u, _buffer.size()));
+				response_us = tm_ready - tm_begin;
+				return Answer::LINE;
+			}
+			if(_eof) {
+				return Answer::OVER;
+			}
+
+			timespec timeout{};
+			if(deadline != NO_TIMEOUT) {
+				const uint64_t tm = now_us();
+				if(tm >= deadline) {
+					response_us = tm - tm_begin;
+					return Answer::TIMEOUT;
+				}
+				timeout.tv_sec = time_t((deadline - tm) / 1000000u);
+				timeout.tv_nsec = long((deadline - tm) % 1000000u * 1000u);
+			}
+
+			pollfd pfd{fileno(_in), POLLIN, 0};
+			const int ready = ppoll(&pfd, 1, deadline != NO_TIMEOUT ? &timeout : nullptr, nullptr);
+			if(ready == 0 || (ready < 0 && errno == EINTR)) {
+				continue;
+			}
+			tm_ready = now_us();
+
+			char chunk[4096];
+			const ssize_t size = ready > 0 ? read(pfd.fd, chunk, sizeof(chunk)) : -1;
+			if(size > 0) {
+				_buffer.append(chunk, size_t(size));
+			} else if(size == 0 || errno != EINTR) {
+				_eof = true;
+			}
+		}
+	}
+
+	bool say(const std::string& to_say) override {
+		std::string command("trans -b -p  :en :jpn \"");
+		command.append(to_say);
+		command.append("\" >> /dev/null");
+
+		if(system(command.c_str()) != EXIT_SUCCESS) {
+			fprintf(stderr, "system(\"%s\") fails\n", command.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	uint64_t clock_ms() override {
+		using namespace std::chrono;
+		return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+	}
+
+private:
+
+	static uint64_t now_us() {
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return uint64_t(ts.tv_sec) * 1000000u + uint64_t(ts.tv_nsec) / 1000u;
+	}
+
+};
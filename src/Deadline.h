@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * The deadline of the speed drill and the response times of the session.
+ *
+ * The deadline follows SLACK times the moving average of the right answers in time,
+ * it shrinks as the learner gets faster and never exceeds the deadline given.
+ */
+class Deadline {
+	static constexpr uint64_t MIN_US = 500000u;
+	static constexpr double SLACK = 1.5;
+	static constexpr double WEIGHT = 0.2;
+
+	const uint64_t _max_us;
+	uint64_t _current_us;
+	double _average_us;
+	std::vector<uint64_t> _responses_us;
+	unsigned _late = 0;
+
+public:
+
+	/**
+	 * @max_us of 0 is no deadline.
+	 */
+	explicit Deadline(const uint64_t max_us) :
+		_max_us(max_us), _current_us(max_us), _average_us(double(max_us) / SLACK) {}
+
+	bool enabled() const {
+		return _max_us > 0;
+	}
+
+	uint64_t current_us() const {
+		return _current_us;
+	}
+
+	/**
+	 * Counts the first answer of a round, a late one takes the whole deadline.
+	 */
+	void answer(const uint64_t response_us, const bool late, const bool correct) {
+		_responses_us.push_back(late ? std::max(response_us, _current_us) : response_us);
+		if(late) {
+			++_late;
+			return;
+		}
+		if(correct) {
+			_average_us += (double(response_us) - _average_us) * WEIGHT;
+			_current_us = std::clamp(uint64_t(_average_us * SLACK), std::min(MIN_US, _max_us), _max_us);
+		}
+	}
+
+	unsigned count() const {
+		return unsigned(_responses_us.size());
+	}
+
+	unsigned late() const {
+		return _late;
+	}
+
+	uint64_t mean_us() const {
+		uint64_t sum = 0;
+		for(const uint64_t response_us : _responses_us) {
+			sum += response_us;
+		}
+		return _responses_us.empty() ? 0 : sum / _responses_us.size();
+	}
+
+	/**
+	 * @return The response time below which @percent of the answers are.
+	 */
+	uint64_t percentile_us(const unsigned percent) const {
+		if(_responses_us.empty()) {
+			return 0;
+		}
+		std::vector<uint64_t> sorted(_responses_us);
+		const size_t idx = std::min(sorted.size() - 1u, sorted.size() * percent / 100u);
+		std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+		return sorted[idx];
+	}
+
+};
@@ -10,6 +10,9 @@ class DiceMachine {
 	uint16_t m_seed[3];
 public:
 
+	/**
+	 * Only the low 48 bits of @seed are used, a seed from state() continues the stream.
+	 */
 	explicit DiceMachine(const uint64_t seed) {
 		m_seed[2] = uint16_t((seed >> uint64_t(0)) & uint64_t(0xFFFF));
 		m_seed[1] = uint16_t((seed >> uint64_t(16)) & uint64_t(0xFFFF));
@@ -37,4 +40,28 @@ public:
 		return jrand48(m_seed);
 	}
 
+	/**
+	 * @return A number in [0, @range) from a single 48-bit draw if @range is below 2^48.
+	 */
+	uint64_t below(const uint64_t range) {
+		if(range <= RANGE_48) {
+			return uint64_t((__uint128_t(draw48()) * range) >> 48u);
+		}
+		const uint64_t bits = (draw48() << 16u) ^ draw48();
+		return uint64_t((__uint128_t(bits) * range) >> 64u);
+	}
+
+	uint64_t state() const {
+		return uint64_t(m_seed[2]) | (uint64_t(m_seed[1]) << 16u) | (uint64_t(m_seed[0]) << 32u);
+	}
+
+private:
+
+	static constexpr uint64_t RANGE_48 = uint64_t(1) << 48u;
+
+	uint64_t draw48() {
+		nrand48(m_seed);
+		return uint64_t(m_seed[0]) | (uint64_t(m_seed[1]) << 16u) | (uint64_t(m_seed[2]) << 32u);
+	}
+
 };
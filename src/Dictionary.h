@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * A dictionary file, one entry per line :
+ *
+ *   # comment
+ *   kanji	; kana	; meaning	; tags
+ *
+ * The kanji and the tags may be empty, the tags are separated by spaces. The entries refer to the file content.
+ */
+class Dictionary {
+public:
+
+	struct Entry {
+		std::string_view kanji;
+		std::string_view kana;
+		std::string_view meaning;
+		std::string_view tags;
+
+		/**
+		 * @return The kanji or the kana if there are no kanji.
+		 */
+		std::string_view expression() const {
+			return kanji.empty() ? kana : kanji;
+		}
+	};
+
+private:
+
+	std::string _content;
+	std::vector<Entry> _entries;
+	std::string _error;
+
+public:
+
+	Dictionary() = default;
+	Dictionary(const Dictionary&) = delete;
+	Dictionary& operator=(const Dictionary&) = delete;
+
+	bool load(const char* path) {
+		_content.clear();
+		_entries.clear();
+
+		FILE* file = fopen(path, "rb");
+		if(file == nullptr) {
+			_error = std::string("can not open '") + path + "'";
+			return false;
+		}
+
+		char buf[1u << 16u];
+		size_t len;
+		while((len = fread(buf, 1, sizeof(buf), file)) > 0) {
+			_content.append(buf, len);
+		}
+		fclose(file);
+
+		return parse();
+	}
+
+	/**
+	 * Parses the dictionary from @content instead of a file.
+	 */
+	bool assign(std::string content) {
+		_content = std::move(content);
+		_entries.clear();
+		return parse();
+	}
+
+	const std::vector<Entry>& entries() const {
+		return _entries;
+	}
+
+	size_t size() const {
+		return _entries.size();
+	}
+
+	const Entry& operator[](const size_t idx) const {
+		return _entries[idx];
+	}
+
+	const std::string& error() const {
+		return _error;
+	}
+
+	static std::string_view trim(std::string_view str) {
+		while(not str.empty() && is_space(str.front())) {
+			str.remove_prefix(1);
+		}
+		while(not str.empty() && is_space(str.back())) {
+			str.remove_suffix(1);
+		}
+		return str;
+	}
+
+private:
+
+	bool parse() {
+		const std::string_view content(_content);
+		size_t line_no = 0;
+		size_t pos = 0;
+
+		while(pos < content.size()) {
+			size_t end = content.find('\n', pos);
+			if(end == std::string_view::npos) {
+				end = content.size();
+			}
+			const std::string_view line = content.substr(pos, end - pos);
+			pos = end + 1u;
+			++line_no;
+
+			if(trim(line).empty() || trim(line).front() == '#') {
+				continue;
+			}
+
+			const size_t sep_a = line.find(';');
+			const size_t sep_b = (sep_a == std::string_view::npos) ? sep_a : line.find(';', sep_a + 1u);
+			if(sep_b == std::string_view::npos) {
+				_error = "less than three fields at line " + std::to_string(line_no);
+				return false;
+			}
+
+			Entry entry;
+			entry.kanji = trim(line.substr(0, sep_a));
+			entry.kana = trim(line.substr(sep_a + 1u, sep_b - sep_a - 1u));
+			const size_t sep_c = line.find(';', sep_b + 1u);
+			entry.meaning = trim(line.substr(sep_b + 1u, sep_c == std::string_view::npos ? sep_c : sep_c - sep_b - 1u));
+			if(sep_c != std::string_view::npos) {
+				entry.tags = trim(line.substr(sep_c + 1u));
+			}
+			if(entry.kana.empty()) {
+				_error = "no kana at line " + std::to_string(line_no);
+				return false;
+			}
+			_entries.push_back(entry);
+		}
+		return true;
+	}
+
+	static bool is_space(const char ch) {
+		return ch == ' ' || ch == '\t' || ch == '\r';
+	}
+
+};
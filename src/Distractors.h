@@ -0,0 +1,114 @@
+#pragma once
+
+#include "DiceMachine.h"
+#include "Number.h"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+/**
+ * Wrong choices whose readings are close to the answer, for the multiple choice drills.
+ *
+ * The candidates are mutations of the digits of the answer along its phonetic features :
+ * a digit moved to the next unit (三万五千 and 五万三千, 三千五百), a digit of a similar sound
+ * (さんぜん and はっせん, いち and しち) and a digit one apart. Only if the answer has too few
+ * of them, the candidates of the candidates are taken. Nothing is allocated.
+ */
+class Distractors {
+public:
+
+	static constexpr unsigned MAX_COUNT = 8u;
+
+private:
+
+	static constexpr size_t POOL_SIZE = 256u;
+
+	// The digits of a similar sound as bits : 3 and 8 of さんびゃく and はっぴゃく, 1 and 7 of いち and しち.
+	static constexpr uint16_t SIMILAR[10] = {
+		0, 1u << 7u, 0, 1u << 8u, 1u << 7u, 0, 1u << 8u, (1u << 1u) | (1u << 4u), (1u << 3u) | (1u << 6u), 0
+	};
+
+	std::array<uint64_t, POOL_SIZE> _pool;
+	size_t _size = 0;
+	uint64_t _answer = 0;
+	unsigned _max_width = 0;
+
+public:
+
+	/**
+	 * Writes @count distinct distractors of @answer, of up to @max_width digits, into @output.
+	 * @count must not exceed MAX_COUNT.
+	 */
+	void generate(DiceMachine& dm, const Number& answer, const unsigned max_width, Number* output, const unsigned count) {
+		_size = 0;
+		_answer = answer.value;
+		_max_width = max_width;
+
+		mutate(answer.value);
+		for(size_t idx = 0; _size < count && idx < _size; ++idx) {
+			mutate(_pool[idx]);
+		}
+
+		// A partial shuffle picks the distractors without a repetition.
+		for(unsigned i = 0; i < count && i < _size; ++i) {
+			std::swap(_pool[i], _pool[i + dm.below(_size - i)]);
+			output[i] = Number(_pool[i], Number(_pool[i], 1u).significant());
+		}
+	}
+
+private:
+
+	void add(const uint64_t value) {
+		if(value == 0 || value == _answer || value >= Number::POW10[_max_width] || _size == POOL_SIZE) {
+			return;
+		}
+		for(size_t idx = 0; idx < _size; ++idx) {
+			if(_pool[idx] == value) {
+				return;
+			}
+		}
+		_pool[_size++] = value;
+	}
+
+	void mutate(const uint64_t value) {
+		const unsigned width = Number(value, 1u).significant();
+
+		// 三千 and 三万.
+		if(width < _max_width) {
+			add(value * 10u);
+		}
+		if(value % 10u == 0) {
+			add(value / 10u);
+		}
+
+		for(unsigned exp = 0; exp < width; ++exp) {
+			const uint64_t unit = Number::POW10[exp];
+			const unsigned digit = unsigned(value / unit % 10u);
+			const uint64_t base = value - digit * unit;
+			const unsigned min = exp + 1u == width ? 1u : 0u;
+
+			// 三万五千 and 五万三千.
+			if(exp + 1u < width) {
+				const unsigned next = unsigned(value / (unit * 10u) % 10u);
+				if(next != digit && (digit > 0 || exp + 2u < width)) {
+					add(base - next * unit * 10u + next * unit + digit * unit * 10u);
+				}
+			}
+
+			for(unsigned similar = SIMILAR[digit], bit = 0; similar != 0; similar >>= 1u, ++bit) {
+				if(similar & 1u) {
+					add(base + bit * unit);
+				}
+			}
+
+			if(digit > min) {
+				add(base + (digit - 1u) * unit);
+			}
+			if(digit < 9u) {
+				add(base + (digit + 1u) * unit);
+			}
+		}
+	}
+
+};
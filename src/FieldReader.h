@@ -85,18 +85,9 @@ public:
 
 private:
 
-	// TODO: linear time complexity
 	template <typename Enum, typename Converter, bool Pedantic>
 	static Enum as_enum(EnumField<Enum, Converter, Pedantic>&, const std::string_view& str) {
-		auto result = Enum::__SIZE;
-		for(EnumBase_t i = 0; i < static_cast<EnumBase_t>(Enum::__SIZE); ++i) {
-			const auto val = static_cast<Enum>(i);
-			if(str == EnumField<Enum,Converter>::to_cstr(val)) {
-				result = val;
-				break;
-			}
-		}
-		return result;
+		return EnumNameHash<Enum, Converter>::find(str);
 	}
 
 };
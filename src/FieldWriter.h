@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdio>
 #include <string>
 #include <type_traits>
 
@@ -13,6 +14,13 @@ struct FieldWriter {
 		buf.append(std::to_string(value));
 	}
 
+	template <typename V, std::enable_if_t<(std::is_floating_point_v<V>), int> = 0>
+	static void write(std::string& buf, const V& value) {
+		char tmp[32];
+		const int len = snprintf(tmp, sizeof(tmp), "%g", double(value));
+		buf.append(tmp, size_t(len));
+	}
+
 	static void write(std::string& buf, const std::string& value) {
 		buf.append(value);
 	}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "Utf8.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Typo tolerant check of a typed meaning against the glosses of a dictionary entry.
+ *
+ * Both sides are case folded (Latin and Cyrillic, ё as е), the spaces are collapsed
+ * and a leading "to " is dropped. The Levenshtein distance is computed bit-parallel
+ * (Myers, Hyyrö) with the answer as the pattern, so one pattern serves all the glosses.
+ */
+class FuzzyMatcher {
+public:
+
+	static constexpr size_t MAX_LENGTH = 256u;
+
+private:
+
+	static constexpr size_t WORD_BITS = 64u;
+	static constexpr size_t ASCII = 128u;
+
+	struct Text {
+		std::array<char32_t, MAX_LENGTH> data;
+		size_t size = 0;
+	};
+
+	/**
+	 * The positions of every pattern character.
+	 */
+	struct PatternMasks {
+		std::array<uint64_t, ASCII> ascii{};
+		std::array<char32_t, WORD_BITS> other_cp;
+		std::array<uint64_t, WORD_BITS> other_mask;
+		size_t others = 0;
+
+		uint64_t operator[](const char32_t cp) const {
+			if(cp < ASCII) {
+				return ascii[cp];
+			}
+			for(size_t i = 0; i < others; ++i) {
+				if(other_cp[i] == cp) {
+					return other_mask[i];
+				}
+			}
+			return 0;
+		}
+
+		void add(const char32_t cp, const uint64_t bit) {
+			if(cp < ASCII) {
+				ascii[cp] |= bit;
+				return;
+			}
+			for(size_t i = 0; i < others; ++i) {
+				if(other_cp[i] == cp) {
+					other_mask[i] |= bit;
+					return;
+				}
+			}
+			other_cp[others] = cp;
+			other_mask[others] = bit;
+			++others;
+		}
+	};
+
+public:
+
+	/**
+	 * @return true if the @answer is within @threshold edits per character
+	 * of any comma separated gloss of @meaning or of the whole @meaning.
+	 */
+	static bool matches(const std::string_view& meaning, const std::string_view& answer, const double threshold) {
+		Text pattern;
+		fold(answer, pattern);
+		if(pattern.size == 0) {
+			return false;
+		}
+
+		PatternMasks masks;
+		if(pattern.size <= WORD_BITS) {
+			for(size_t i = 0; i < pattern.size; ++i) {
+				masks.add(pattern.data[i], uint64_t(1u) << i);
+			}
+		}
+
+		auto accepts = [&pattern, &masks, threshold](const Text& gloss) {
+			if(gloss.size == 0) {
+				return false;
+			}
+			const auto allowed = unsigned(threshold * double(gloss.size));
+			const unsigned dist = pattern.size <= WORD_BITS ? distance(masks, pattern.size, gloss) : distance(pattern, gloss);
+			return dist <= allowed;
+		};
+
+		Text gloss;
+		std::string_view rest = meaning;
+		size_t comma;
+		while((comma = rest.find(',')) != std::string_view::npos) {
+			fold(rest.substr(0, comma), gloss);
+			if(accepts(gloss)) {
+				return true;
+			}
+			rest.remove_prefix(comma + 1u);
+		}
+		fold(rest, gloss);
+		if(accepts(gloss)) {
+			return true;
+		}
+
+		if(rest.size() != meaning.size()) {
+			fold(meaning, gloss);
+			return accepts(gloss);
+		}
+		return false;
+	}
+
+	/**
+	 * @return The edit distance between the folded strings.
+	 */
+	static unsigned distance(const std::string_view& a, const std::string_view& b) {
+		Text pattern;
+		Text text;
+		fold(a, pattern);
+		fold(b, text);
+		if(pattern.size == 0 || pattern.size > WORD_BITS) {
+			return distance(pattern, text);
+		}
+
+		PatternMasks masks;
+		for(size_t i = 0; i < pattern.size; ++i) {
+			masks.add(pattern.data[i], uint64_t(1u) << i);
+		}
+		return distance(masks, pattern.size, text);
+	}
+
+private:
+
+	/**
+	 * Myers' bit-vector algorithm in Hyyrö's formulation for the global distance.
+	 */
+	static unsigned distance(const PatternMasks& masks, const size_t m, const Text& text) {
+		const uint64_t high = uint64_t(1u) << (m - 1u);
+		uint64_t pv = (m == WORD_BITS) ? ~uint64_t(0) : (high << 1u) - 1u;
+		uint64_t mv = 0;
+		auto score = unsigned(m);
+
+		for(size_t j = 0; j < text.size; ++j) {
+			const uint64_t eq = masks[text.data[j]];
+			const uint64_t xv = eq | mv;
+			const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+			uint64_t ph = mv | ~(xh | pv);
+			uint64_t mh = pv & xh;
+
+			if(ph & high) {
+				++score;
+			} else if(mh & high) {
+				--score;
+			}
+
+			// The first row grows by one per text character.
+			ph = (ph << 1u) | 1u;
+			mh <<= 1u;
+			pv = mh | ~(xv | ph);
+			mv = ph & xv;
+		}
+
+		return score;
+	}
+
+	/**
+	 * The plain dynamic programming for the patterns longer than a machine word.
+	 */
+	static unsigned distance(const Text& a, const Text& b) {
+		std::array<unsigned, MAX_LENGTH + 1u> row;
+		for(size_t j = 0; j <= b.size; ++j) {
+			row[j] = unsigned(j);
+		}
+		for(size_t i = 1; i <= a.size; ++i) {
+			unsigned diag = row[0];
+			row[0] = unsigned(i);
+			for(size_t j = 1; j <= b.size; ++j) {
+				const unsigned up = row[j];
+				const unsigned subst = diag + (a.data[i - 1u] == b.data[j - 1u] ? 0u : 1u);
+				row[j] = std::min(std::min(up, row[j - 1u]) + 1u, subst);
+				diag = up;
+			}
+		}
+		return row[b.size];
+	}
+
+	/**
+	 * Decodes, folds and normalizes @str, the characters over MAX_LENGTH are dropped.
+	 */
+	static void fold(const std::string_view& str, Text& out) {
+		out.size = 0;
+		bool space = true;
+		size_t pos = 0;
+
+		while(pos < str.size() && out.size < MAX_LENGTH) {
+			const char32_t cp = Utf8::fold(Utf8::decode(str, pos));
+			if(cp == ' ' || cp == '\t' || cp == '\n' || cp == '\r') {
+				if(not space) {
+					out.data[out.size++] = ' ';
+				}
+				space = true;
+			} else {
+				out.data[out.size++] = cp;
+				space = false;
+			}
+		}
+
+		if(out.size > 0 && out.data[out.size - 1u] == ' ') {
+			--out.size;
+		}
+
+		if(out.size > 3u && out.data[0] == 't' && out.data[1] == 'o' && out.data[2] == ' ') {
+			for(size_t i = 3; i < out.size; ++i) {
+				out.data[i - 3u] = out.data[i];
+			}
+			out.size -= 3u;
+		}
+	}
+
+};
@@ -0,0 +1,271 @@
+#pragma once
+
+#include "Lexicon.h"
+#include "Utf8.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Inverted index from the words of the meanings to the words of a lexicon.
+ *
+ * A term is a case folded run of letters of one script (Latin, Cyrillic) or of digits,
+ * so "to open,открыть" gives "open" and "открыть", the frequent particles are not indexed.
+ * The posting lists are delta and varint coded in one arena with a skip entry
+ * every SKIP_BLOCK postings. A query is the intersection of the lists of its terms.
+ */
+class GlossIndex {
+public:
+
+	static constexpr size_t SKIP_BLOCK = 128u;
+	static constexpr size_t MAX_TERMS = 8u;
+
+private:
+
+	struct Skip {
+		uint32_t base;
+		uint32_t byte;
+	};
+
+	struct Posting {
+		uint32_t byte;
+		uint32_t bytes;
+		uint32_t count;
+		uint32_t skip;
+	};
+
+	/**
+	 * Decodes a posting list, advance() jumps over the blocks before the target.
+	 */
+	struct Cursor {
+		const uint8_t* begin;
+		const uint8_t* ptr;
+		const uint8_t* end;
+		const Skip* skips;
+		size_t blocks;
+		size_t count;
+		size_t pos = 0;
+		uint32_t doc = 0;
+
+		bool next() {
+			if(ptr == end) {
+				return false;
+			}
+			uint32_t delta = 0;
+			unsigned shift = 0;
+			uint8_t byte;
+			do {
+				byte = *ptr++;
+				delta |= uint32_t(byte & 0x7Fu) << shift;
+				shift += 7u;
+			} while(byte & 0x80u);
+			doc = (pos == 0) ? delta : doc + delta;
+			++pos;
+			return true;
+		}
+
+		bool advance(const uint32_t target) {
+			if(pos > 0 && doc >= target) {
+				return true;
+			}
+
+			// skips[k] is the last doc before the block k + 1.
+			const size_t block = pos / SKIP_BLOCK;
+			size_t last = block;
+			while(last + 1u < blocks && skips[last].base < target) {
+				++last;
+			}
+			if(last > block) {
+				ptr = begin + skips[last - 1u].byte;
+				doc = skips[last - 1u].base;
+				pos = last * SKIP_BLOCK;
+			}
+
+			while(next()) {
+				if(doc >= target) {
+					return true;
+				}
+			}
+			return false;
+		}
+	};
+
+	std::unordered_map<std::string, Posting> _terms;
+	std::vector<uint8_t> _postings;
+	std::vector<Skip> _skips;
+
+public:
+
+	/**
+	 * Indexes the meanings of all the words of @lex.
+	 */
+	void build(const Lexicon& lex) {
+		std::unordered_map<std::string, std::vector<uint32_t>> lists;
+		std::string term;
+		for(size_t idx = 0; idx < lex.size(); ++idx) {
+			tokenize(lex[idx].meaning, term, [&lists, idx](const std::string& item) {
+				std::vector<uint32_t>& list = lists[item];
+				if(list.empty() || list.back() != idx) {
+					list.push_back(uint32_t(idx));
+				}
+			});
+		}
+
+		_terms.clear();
+		_terms.reserve(lists.size());
+		_postings.clear();
+		_skips.clear();
+		for(const auto& item : lists) {
+			_terms.emplace(item.first, encode(item.second));
+		}
+	}
+
+	/**
+	 * Appends to @result up to @limit words having all the terms of @query in their meanings.
+	 * @return The number of the words appended.
+	 */
+	size_t find(const std::string_view& query, std::vector<uint32_t>& result, const size_t limit) const {
+		std::array<Cursor, MAX_TERMS> cursors;
+		size_t size = 0;
+		bool missing = false;
+
+		std::string term;
+		tokenize(query, term, [this, &cursors, &size, &missing](const std::string& item) {
+			const auto it = _terms.find(item);
+			if(it == _terms.end()) {
+				missing = true;
+			} else if(size < MAX_TERMS) {
+				cursors[size++] = cursor(it->second);
+			}
+		});
+		if(missing || size == 0 || limit == 0) {
+			return 0;
+		}
+
+		// The shortest list leads.
+		std::sort(cursors.begin(), cursors.begin() + size, [](const Cursor& lv, const Cursor& rv) {
+			return lv.count < rv.count;
+		});
+
+		size_t found = 0;
+		Cursor& lead = cursors[0];
+		if(not lead.next()) {
+			return 0;
+		}
+		uint32_t target = lead.doc;
+		while(true) {
+			bool all = true;
+			for(size_t i = 1; i < size; ++i) {
+				if(not cursors[i].advance(target)) {
+					return found;
+				}
+				if(cursors[i].doc > target) {
+					target = cursors[i].doc;
+					all = false;
+					break;
+				}
+			}
+
+			if(all) {
+				result.push_back(target);
+				if(++found == limit || not lead.next()) {
+					return found;
+				}
+			} else if(not lead.advance(target)) {
+				return found;
+			}
+			target = lead.doc;
+		}
+	}
+
+	size_t terms() const {
+		return _terms.size();
+	}
+
+	/**
+	 * @return The size of the posting lists and the skips.
+	 */
+	size_t bytes() const {
+		return _postings.size() + _skips.size() * sizeof(Skip);
+	}
+
+	/**
+	 * Calls @fn with every term of @text, @term is the buffer for it.
+	 */
+	template <typename F>
+	static void tokenize(const std::string_view& text, std::string& term, F&& fn) {
+		term.clear();
+		Utf8::Script script = Utf8::Script::OTHER;
+		size_t pos = 0;
+		while(true) {
+			const bool end = pos >= text.size();
+			const char32_t cp = end ? 0 : Utf8::fold(Utf8::decode(text, pos));
+			const Utf8::Script cur = end ? Utf8::Script::OTHER : Utf8::script(cp);
+
+			if(cur != script && (not term.empty())) {
+				if(not is_stop_word(term)) {
+					fn(term);
+				}
+				term.clear();
+			}
+			if(end) {
+				return;
+			}
+			script = cur;
+			if(cur != Utf8::Script::OTHER) {
+				Utf8::append(cp, term);
+			}
+		}
+	}
+
+private:
+
+	static bool is_stop_word(const std::string& term) {
+		static constexpr const char* STOP_WORDS[] = {
+			"a", "an", "the", "to", "of", "or", "and", "be", "etc",
+			"и", "или", "в", "на", "с"
+		};
+		for(const char* item : STOP_WORDS) {
+			if(term == item) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	Posting encode(const std::vector<uint32_t>& docs) {
+		Posting result{uint32_t(_postings.size()), 0, uint32_t(docs.size()), uint32_t(_skips.size())};
+		uint32_t prev = 0;
+		for(size_t i = 0; i < docs.size(); ++i) {
+			if(i > 0 && i % SKIP_BLOCK == 0) {
+				_skips.push_back(Skip{prev, uint32_t(_postings.size()) - result.byte});
+			}
+			uint32_t delta = docs[i] - prev;
+			while(delta >= 0x80u) {
+				_postings.push_back(uint8_t(delta | 0x80u));
+				delta >>= 7u;
+			}
+			_postings.push_back(uint8_t(delta));
+			prev = docs[i];
+		}
+		result.bytes = uint32_t(_postings.size()) - result.byte;
+		return result;
+	}
+
+	Cursor cursor(const Posting& posting) const {
+		Cursor result;
+		result.begin = _postings.data() + posting.byte;
+		result.ptr = result.begin;
+		result.end = result.begin + posting.bytes;
+		result.skips = _skips.data() + posting.skip;
+		result.blocks = (posting.count + SKIP_BLOCK - 1u) / SKIP_BLOCK;
+		result.count = posting.count;
+		return result;
+	}
+
+};
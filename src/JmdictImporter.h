@@ -0,0 +1,285 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "XmlScanner.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+/**
+ * Converts a JMdict XML file into the dictionary format in a single pass :
+ *
+ *   kanji	; kana	; gloss, gloss ...	; tags
+ *
+ * The first headword and the first reading are taken with their priority tags
+ * (news1, ichi1, spec1, gai1, nfXX) and the parts of speech of the first sense (v5r, adj-i ...).
+ * The glosses are taken in one language, the entries without them are skipped.
+ * JMdict itself has no JLPT levels.
+ *
+ * The file is mapped and scanned in place, an entry only refers to it,
+ * and the output is written in blocks, so the memory does not depend on the file size.
+ */
+class JmdictImporter {
+
+	static constexpr size_t MAX_GLOSSES = 8u;
+	static constexpr size_t MAX_TAGS = 16u;
+	static constexpr size_t OUTPUT_BLOCK = 1u << 20u;
+
+	enum class Field {
+		NONE,
+		KEB,
+		REB,
+		KE_PRI,
+		RE_PRI,
+		POS,
+		GLOSS
+	};
+
+	struct Entry {
+		std::string_view keb;
+		std::string_view reb;
+		unsigned k_ele = 0;
+		unsigned r_ele = 0;
+		unsigned senses = 0;
+		std::array<std::string_view, MAX_GLOSSES> glosses;
+		size_t glosses_size = 0;
+		std::array<std::string_view, MAX_TAGS> tags;
+		size_t tags_size = 0;
+
+		void clear() {
+			keb = std::string_view();
+			reb = std::string_view();
+			k_ele = 0;
+			r_ele = 0;
+			senses = 0;
+			glosses_size = 0;
+			tags_size = 0;
+		}
+
+		void add_tag(std::string_view tag) {
+			// The parts of speech are entity references.
+			if(tag.size() > 2u && tag.front() == '&' && tag.back() == ';') {
+				tag = tag.substr(1u, tag.size() - 2u);
+			}
+			if(tag.empty() || tags_size == MAX_TAGS || tag.find_first_of(" \t\n;&") != std::string_view::npos) {
+				return;
+			}
+			for(size_t i = 0; i < tags_size; ++i) {
+				if(tags[i] == tag) {
+					return;
+				}
+			}
+			tags[tags_size++] = tag;
+		}
+	};
+
+	const std::string _language;
+	std::string _error;
+	std::string _block;
+	uint64_t _entries = 0;
+	uint64_t _written = 0;
+	uint64_t _bytes = 0;
+
+public:
+
+	/**
+	 * @language ISO 639-2 code of the glosses, "eng" is the default of JMdict.
+	 */
+	explicit JmdictImporter(std::string language) : _language(std::move(language)) {}
+
+	bool import(const char* path, FILE* out) {
+		MappedFile file;
+		if(not file.open(path)) {
+			_error = file.error();
+			return false;
+		}
+		_bytes = file.size();
+
+		_block.clear();
+		_block.reserve(OUTPUT_BLOCK + 4096u);
+
+		XmlScanner xml(file.data(), file.size());
+		Entry entry;
+		Field field = Field::NONE;
+		bool in_entry = false;
+
+		while(true) {
+			switch(xml.next()) {
+				case XmlScanner::Token::OPEN:
+					field = Field::NONE;
+					if(xml.name() == "entry") {
+						entry.clear();
+						in_entry = true;
+					} else if(not in_entry) {
+						break;
+					} else if(xml.name() == "k_ele") {
+						++entry.k_ele;
+					} else if(xml.name() == "r_ele") {
+						++entry.r_ele;
+					} else if(xml.name() == "sense") {
+						++entry.senses;
+					} else if(xml.name() == "keb") {
+						field = entry.k_ele == 1u ? Field::KEB : Field::NONE;
+					} else if(xml.name() == "reb") {
+						field = entry.r_ele == 1u ? Field::REB : Field::NONE;
+					} else if(xml.name() == "ke_pri") {
+						field = entry.k_ele == 1u ? Field::KE_PRI : Field::NONE;
+					} else if(xml.name() == "re_pri") {
+						field = entry.r_ele == 1u ? Field::RE_PRI : Field::NONE;
+					} else if(xml.name() == "pos") {
+						field = entry.senses == 1u ? Field::POS : Field::NONE;
+					} else if(xml.name() == "gloss") {
+						std::string_view lang = xml.attribute("xml:lang");
+						if(lang.empty()) {
+							lang = "eng";
+						}
+						field = lang == _language ? Field::GLOSS : Field::NONE;
+					}
+					break;
+
+				case XmlScanner::Token::TEXT:
+					collect(field, XmlScanner::trim(xml.text()), entry);
+					break;
+
+				case XmlScanner::Token::CLOSE:
+					field = Field::NONE;
+					if(xml.name() == "entry" && in_entry) {
+						in_entry = false;
+						++_entries;
+						write(entry);
+						if(_block.size() >= OUTPUT_BLOCK && not flush(out)) {
+							return false;
+						}
+					}
+					break;
+
+				case XmlScanner::Token::END:
+					return flush(out);
+
+				case XmlScanner::Token::ERROR:
+					_error = "malformed XML at byte " + std::to_string(xml.position() - file.data());
+					return false;
+			}
+		}
+	}
+
+	/**
+	 * @return The number of entries in the file.
+	 */
+	uint64_t entries() const {
+		return _entries;
+	}
+
+	/**
+	 * @return The number of entries written.
+	 */
+	uint64_t written() const {
+		return _written;
+	}
+
+	/**
+	 * @return The size of the file.
+	 */
+	uint64_t bytes() const {
+		return _bytes;
+	}
+
+	const std::string& error() const {
+		return _error;
+	}
+
+private:
+
+	static void collect(const Field field, const std::string_view& text, Entry& entry) {
+		switch(field) {
+			case Field::KEB:
+				entry.keb = text;
+				break;
+
+			case Field::REB:
+				entry.reb = text;
+				break;
+
+			case Field::KE_PRI:
+			case Field::RE_PRI:
+			case Field::POS:
+				entry.add_tag(text);
+				break;
+
+			case Field::GLOSS:
+				if(entry.glosses_size < MAX_GLOSSES && not text.empty()) {
+					entry.glosses[entry.glosses_size++] = text;
+				}
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	bool flush(FILE* out) {
+		if(fwrite(_block.data(), 1, _block.size(), out) != _block.size()) {
+			_error = "can not write";
+			return false;
+		}
+		_block.clear();
+		return true;
+	}
+
+	void write(const Entry& entry) {
+		if(entry.reb.empty() || entry.glosses_size == 0) {
+			return;
+		}
+
+		append_text(entry.keb);
+		_block.append("\t; ");
+		append_text(entry.reb);
+		_block.append("\t; ");
+		for(size_t i = 0; i < entry.glosses_size; ++i) {
+			if(i > 0) {
+				_block.append(", ");
+			}
+			append_text(entry.glosses[i]);
+		}
+		if(entry.tags_size > 0) {
+			_block.append("\t; ");
+			for(size_t i = 0; i < entry.tags_size; ++i) {
+				if(i > 0) {
+					_block.push_back(' ');
+				}
+				_block.append(entry.tags[i]);
+			}
+		}
+		_block.push_back('\n');
+		++_written;
+	}
+
+	/**
+	 * Appends the unescaped text, the separators and line breaks of the dictionary format are replaced.
+	 */
+	void append_text(const std::string_view& raw) {
+		XmlScanner::unescape(raw, [this](const std::string_view& piece) {
+			for(const char ch : piece) {
+				switch(ch) {
+					case ';':
+						_block.push_back(',');
+						break;
+
+					case '\t':
+					case '\n':
+					case '\r':
+						_block.push_back(' ');
+						break;
+
+					default:
+						_block.push_back(ch);
+						break;
+				}
+			}
+		});
+	}
+
+};
@@ -0,0 +1,353 @@
+#pragma once
+
+#include "Dictionary.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Dictionaries of several levels merged into one list of unique words.
+ *
+ * The level of a file comes from its name (n5.dic ... n1.dic), a word found in several
+ * files keeps the first meaning and gets all the levels. Every word has a bitset of tags
+ * stored apart from the entries, so a filter is a scan over the tags only
+ * and its result is a bitset over the words.
+ */
+class Lexicon {
+public:
+
+	using Entry = Dictionary::Entry;
+	using Tags_t = uint32_t;
+
+	static constexpr Tags_t LEVEL_N5 = 1u << 0u;
+	static constexpr Tags_t LEVEL_N4 = 1u << 1u;
+	static constexpr Tags_t LEVEL_N3 = 1u << 2u;
+	static constexpr Tags_t LEVEL_N2 = 1u << 3u;
+	static constexpr Tags_t LEVEL_N1 = 1u << 4u;
+	static constexpr Tags_t LEVELS = LEVEL_N5 | LEVEL_N4 | LEVEL_N3 | LEVEL_N2 | LEVEL_N1;
+
+	static constexpr Tags_t NOUN = 1u << 8u;
+	static constexpr Tags_t VERB = 1u << 9u;
+	static constexpr Tags_t ADJ_I = 1u << 10u;
+	static constexpr Tags_t ADJ_NA = 1u << 11u;
+	static constexpr Tags_t ADVERB = 1u << 12u;
+	static constexpr Tags_t COMMON = 1u << 15u;
+
+	// User decks, deck0 ... deck7.
+	static constexpr Tags_t DECK_0 = 1u << 16u;
+	static constexpr unsigned DECKS = 8u;
+
+	// Set by the drills.
+	static constexpr Tags_t MASTERED = 1u << 24u;
+
+	/**
+	 * Matches the words having all the tags of @all, any of @any (if not empty) and none of @none.
+	 */
+	struct Filter {
+		Tags_t all = 0;
+		Tags_t any = 0;
+		Tags_t none = 0;
+
+		bool matches(const Tags_t tags) const {
+			return (tags & all) == all && (any == 0 || (tags & any) != 0) && (tags & none) == 0;
+		}
+
+		/**
+		 * Parses a comma separated list of tag names, a '-' prefix excludes the tag.
+		 * The levels are alternatives, the other tags are all required.
+		 */
+		bool parse(std::string_view str) {
+			*this = Filter();
+			while(not str.empty()) {
+				const size_t comma = str.find(',');
+				std::string_view item = Dictionary::trim(str.substr(0, comma));
+				str = (comma == std::string_view::npos) ? std::string_view() : str.substr(comma + 1u);
+
+				const bool exclude = not item.empty() && item.front() == '-';
+				if(exclude) {
+					item.remove_prefix(1);
+				}
+				const Tags_t tag = tag_by_name(item);
+				if(tag == 0) {
+					return false;
+				}
+				if(exclude) {
+					none |= tag;
+				} else if(tag & LEVELS) {
+					any |= tag;
+				} else {
+					all |= tag;
+				}
+			}
+			return true;
+		}
+	};
+
+	/**
+	 * Words selected by a filter, one bit per word.
+	 */
+	class Selection {
+		friend class Lexicon;
+
+		std::vector<uint64_t> _words;
+		size_t _count = 0;
+
+	public:
+
+		size_t count() const {
+			return _count;
+		}
+
+		/**
+		 * Calls @fn with the index of every selected word in order.
+		 */
+		template <typename F>
+		void for_each(F&& fn) const {
+			for(size_t word = 0; word < _words.size(); ++word) {
+				uint64_t bits = _words[word];
+				while(bits != 0) {
+					fn(word * 64u + size_t(__builtin_ctzll(bits)));
+					bits &= bits - 1u;
+				}
+			}
+		}
+	};
+
+private:
+
+	struct Key {
+		std::string_view kanji;
+		std::string_view kana;
+
+		bool operator==(const Key& rv) const {
+			return kanji == rv.kanji && kana == rv.kana;
+		}
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const {
+			const std::hash<std::string_view> hash;
+			return hash(key.kanji) * 31u ^ hash(key.kana);
+		}
+	};
+
+	std::vector<std::unique_ptr<Dictionary>> _files;
+	std::vector<Entry> _entries;
+	std::vector<Tags_t> _tags;
+	std::unordered_map<Key, size_t, KeyHash> _index;
+	std::string _error;
+
+public:
+
+	Lexicon() = default;
+	Lexicon(const Lexicon&) = delete;
+	Lexicon& operator=(const Lexicon&) = delete;
+
+	/**
+	 * Loads and merges a comma separated list of dictionary files.
+	 */
+	bool load(const std::string_view& paths) {
+		size_t pos = 0;
+		while(pos <= paths.size()) {
+			size_t comma = paths.find(',', pos);
+			if(comma == std::string_view::npos) {
+				comma = paths.size();
+			}
+			const std::string path(paths.substr(pos, comma - pos));
+			pos = comma + 1u;
+			if(path.empty()) {
+				continue;
+			}
+
+			auto dic = std::make_unique<Dictionary>();
+			if(not dic->load(path.c_str())) {
+				_error = path + " : " + dic->error();
+				return false;
+			}
+			merge(*dic, level_by_path(path));
+			_files.push_back(std::move(dic));
+		}
+		return true;
+	}
+
+	/**
+	 * Merges a dictionary given as text, @level is one of the levels or zero.
+	 */
+	bool load_text(std::string content, const Tags_t level) {
+		auto dic = std::make_unique<Dictionary>();
+		if(not dic->assign(std::move(content))) {
+			_error = dic->error();
+			return false;
+		}
+		merge(*dic, level);
+		_files.push_back(std::move(dic));
+		return true;
+	}
+
+	/**
+	 * Adds the word or merges its tags with the same word added before.
+	 * The views of @entry must outlive the lexicon.
+	 * @return The index of the word.
+	 */
+	size_t add(const Entry& entry, const Tags_t tags) {
+		const auto inserted = _index.emplace(Key{entry.kanji, entry.kana}, _entries.size());
+		if(inserted.second) {
+			_entries.push_back(entry);
+			_tags.push_back(tags);
+		} else {
+			_tags[inserted.first->second] |= tags;
+		}
+		return inserted.first->second;
+	}
+
+	size_t size() const {
+		return _entries.size();
+	}
+
+	const Entry& operator[](const size_t idx) const {
+		return _entries[idx];
+	}
+
+	Tags_t tags(const size_t idx) const {
+		return _tags[idx];
+	}
+
+	void set(const size_t idx, const Tags_t tags) {
+		_tags[idx] |= tags;
+	}
+
+	void reset(const size_t idx, const Tags_t tags) {
+		_tags[idx] &= ~tags;
+	}
+
+	const std::string& error() const {
+		return _error;
+	}
+
+	void select(const Filter& filter, Selection& result) const {
+		const size_t size = _tags.size();
+		result._words.assign((size + 63u) / 64u, 0);
+		result._count = 0;
+
+		size_t idx = 0;
+#if defined(__SSE2__)
+		const __m128i all = _mm_set1_epi32(int(filter.all));
+		const __m128i any = _mm_set1_epi32(int(filter.any));
+		const __m128i none = _mm_set1_epi32(int(filter.none));
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i ones = _mm_set1_epi32(-1);
+		const __m128i any_empty = _mm_set1_epi32(filter.any == 0 ? -1 : 0);
+
+		for(; idx + 64u <= size; idx += 64u) {
+			uint64_t word = 0;
+			for(unsigned lane = 0; lane < 64u; lane += 4u) {
+				const __m128i tags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_tags.data() + idx + lane));
+				const __m128i has_all = _mm_cmpeq_epi32(_mm_and_si128(tags, all), all);
+				const __m128i has_any = _mm_or_si128(_mm_xor_si128(_mm_cmpeq_epi32(_mm_and_si128(tags, any), zero), ones), any_empty);
+				const __m128i has_none = _mm_cmpeq_epi32(_mm_and_si128(tags, none), zero);
+				const __m128i match = _mm_and_si128(_mm_and_si128(has_all, has_any), has_none);
+				word |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(match))) << lane;
+			}
+			result._words[idx / 64u] = word;
+		}
+#endif
+		for(; idx < size; ++idx) {
+			result._words[idx / 64u] |= uint64_t(filter.matches(_tags[idx])) << (idx % 64u);
+		}
+
+		for(const uint64_t word : result._words) {
+			result._count += size_t(__builtin_popcountll(word));
+		}
+	}
+
+	/**
+	 * @return The tag of the name or zero.
+	 */
+	static Tags_t tag_by_name(const std::string_view& name) {
+		static constexpr struct {
+			const char* name;
+			Tags_t tag;
+		} NAMES[] = {
+			{"n5", LEVEL_N5}, {"n4", LEVEL_N4}, {"n3", LEVEL_N3}, {"n2", LEVEL_N2}, {"n1", LEVEL_N1},
+			{"noun", NOUN}, {"verb", VERB}, {"adj-i", ADJ_I}, {"adj-na", ADJ_NA}, {"adverb", ADVERB},
+			{"common", COMMON}, {"mastered", MASTERED}
+		};
+
+		for(const auto& item : NAMES) {
+			if(name == item.name) {
+				return item.tag;
+			}
+		}
+		if(name.size() == 5u && name.substr(0, 4) == "deck" && name[4] >= '0' && unsigned(name[4] - '0') < DECKS) {
+			return DECK_0 << unsigned(name[4] - '0');
+		}
+		return 0;
+	}
+
+private:
+
+	void merge(const Dictionary& dic, const Tags_t level) {
+		_entries.reserve(_entries.size() + dic.size());
+		_tags.reserve(_tags.size() + dic.size());
+		for(const Entry& entry : dic.entries()) {
+			add(entry, level | tags_of(entry));
+		}
+	}
+
+	/**
+	 * The tags of the tags column : JMdict parts of speech and priorities, the level and deck names.
+	 * Without a part of speech an English meaning starting with "to " makes a verb.
+	 */
+	static Tags_t tags_of(const Entry& entry) {
+		Tags_t result = 0;
+		std::string_view rest = entry.tags;
+		while(not rest.empty()) {
+			const size_t space = rest.find(' ');
+			const std::string_view tag = rest.substr(0, space);
+			rest = (space == std::string_view::npos) ? std::string_view() : rest.substr(space + 1u);
+
+			if(tag == "n" || tag.substr(0, 2) == "n-") {
+				result |= NOUN;
+			} else if(tag.substr(0, 1) == "v" && tag != "vs") {
+				result |= VERB;
+			} else if(tag.substr(0, 5) == "adj-i") {
+				result |= ADJ_I;
+			} else if(tag == "adj-na") {
+				result |= ADJ_NA;
+			} else if(tag.substr(0, 3) == "adv") {
+				result |= ADVERB;
+			} else if(tag == "news1" || tag == "ichi1" || tag == "spec1" || tag == "gai1") {
+				result |= COMMON;
+			} else {
+				result |= tag_by_name(tag);
+			}
+		}
+
+		if((result & (NOUN | VERB | ADJ_I | ADJ_NA | ADVERB)) == 0 && entry.meaning.substr(0, 3) == "to ") {
+			result |= VERB;
+		}
+		return result;
+	}
+
+	/**
+	 * The level of the file name n5.dic ... n1.dic or none.
+	 */
+	static Tags_t level_by_path(const std::string& path) {
+		const size_t slash = path.find_last_of('/');
+		const std::string_view name = std::string_view(path).substr(slash == std::string::npos ? 0 : slash + 1u);
+		if(name.size() >= 2u && (name[0] == 'n' || name[0] == 'N') && name[1] >= '1' && name[1] <= '5') {
+			return LEVEL_N5 << unsigned('5' - name[1]);
+		}
+		return 0;
+	}
+
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+/**
+ * Read-only memory mapping of a whole file, read sequentially.
+ */
+class MappedFile {
+
+	const char* _data = nullptr;
+	size_t _size = 0;
+	std::string _error;
+
+public:
+
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile() {
+		close();
+	}
+
+	bool open(const char* path) {
+		close();
+
+		const int fd = ::open(path, O_RDONLY);
+		if(fd < 0) {
+			_error = std::string("can not open : ") + strerror(errno);
+			return false;
+		}
+
+		struct stat st{};
+		if(fstat(fd, &st) != 0 || st.st_size == 0) {
+			_error = st.st_size == 0 ? "empty file" : std::string("can not stat : ") + strerror(errno);
+			::close(fd);
+			return false;
+		}
+
+		void* data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if(data == MAP_FAILED) {
+			_error = std::string("can not map : ") + strerror(errno);
+			return false;
+		}
+
+		madvise(data, size_t(st.st_size), MADV_SEQUENTIAL);
+		_data = static_cast<const char*>(data);
+		_size = size_t(st.st_size);
+		return true;
+	}
+
+	void close() {
+		if(_data != nullptr) {
+			munmap(const_cast<char*>(_data), _size);
+			_data = nullptr;
+			_size = 0;
+		}
+	}
+
+	const char* data() const {
+		return _data;
+	}
+
+	size_t size() const {
+		return _size;
+	}
+
+	const std::string& error() const {
+		return _error;
+	}
+
+};
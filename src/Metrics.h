@@ -0,0 +1,211 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Process wide counters and histograms in the Prometheus text format.
+ *
+ * Every thread updates its own shard with plain relaxed stores, so an update is
+ * a thread local lookup and an add without a locked instruction. The shards are
+ * summed only when the metrics are written, a shard of a finished thread is kept
+ * for the next thread.
+ */
+class Metrics {
+public:
+
+#define NNS_COUNTER_LIST(X) \
+	X(ROUNDS, "nns_rounds_total", "Rounds served.") \
+	X(MISTAKES, "nns_mistakes_total", "Rounds with a wrong answer.") \
+	X(RETRIES, "nns_retries_total", "Wrong answers, each one is asked again.") \
+	X(SAY, "nns_say_total", "Audio played.") \
+	X(SAY_FAILURES, "nns_say_failures_total", "Audio failed to play.")
+
+	// The histograms : name, help, seconds per unit, upper bound of the first bucket in units.
+#define NNS_HISTOGRAM_LIST(X) \
+	X(RENDER_TIME, "nns_render_seconds", "Time to generate and render a round.", 1e-9, 1000u) \
+	X(INPUT_LATENCY, "nns_input_latency_seconds", "Time from a question to the first answer.", 1e-3, 16u)
+
+#define NNS_METRICS_ENUM(NAME, ...) NAME,
+
+	enum Counter : unsigned {
+		NNS_COUNTER_LIST(NNS_METRICS_ENUM)
+		COUNTERS
+	};
+
+	enum Histogram : unsigned {
+		NNS_HISTOGRAM_LIST(NNS_METRICS_ENUM)
+		HISTOGRAMS
+	};
+
+#undef NNS_METRICS_ENUM
+
+	// Every bucket is twice the previous one, the last one is +Inf.
+	static constexpr unsigned BUCKETS = 16u;
+
+private:
+
+	using Value_t = std::atomic<uint64_t>;
+
+	struct HistogramData {
+		std::array<Value_t, BUCKETS + 1u> buckets{};
+		Value_t sum{0};
+	};
+
+	struct alignas(64) Shard {
+		std::array<Value_t, COUNTERS> counters{};
+		std::array<HistogramData, HISTOGRAMS> histograms{};
+	};
+
+	/**
+	 * Takes a shard on the first update of the thread and gives it back on exit.
+	 */
+	struct ThreadShard {
+		Shard* shard;
+
+		ThreadShard() : shard(instance().attach()) {}
+
+		~ThreadShard() {
+			instance().detach(shard);
+		}
+	};
+
+	std::mutex _mutex;
+	std::vector<std::unique_ptr<Shard>> _shards;
+	std::vector<Shard*> _free;
+
+public:
+
+	static void add(const Counter counter, const uint64_t n = 1u) {
+		increment(shard().counters[counter], n);
+	}
+
+	static void observe(const Histogram histogram, const uint64_t value) {
+		HistogramData& data = shard().histograms[histogram];
+		increment(data.buckets[bucket(value, HISTOGRAM_BASE[histogram])], 1u);
+		increment(data.sum, value);
+	}
+
+	/**
+	 * Appends the text exposition of the sums of all the shards.
+	 */
+	static void write(std::string& out) {
+		std::array<uint64_t, COUNTERS> counters{};
+		std::array<std::array<uint64_t, BUCKETS + 1u>, HISTOGRAMS> buckets{};
+		std::array<uint64_t, HISTOGRAMS> sums{};
+
+		Metrics& metrics = instance();
+		{
+			std::lock_guard<std::mutex> lock(metrics._mutex);
+			for(const auto& item : metrics._shards) {
+				for(unsigned i = 0; i < COUNTERS; ++i) {
+					counters[i] += item->counters[i].load(std::memory_order_relaxed);
+				}
+				for(unsigned i = 0; i < HISTOGRAMS; ++i) {
+					for(unsigned b = 0; b <= BUCKETS; ++b) {
+						buckets[i][b] += item->histograms[i].buckets[b].load(std::memory_order_relaxed);
+					}
+					sums[i] += item->histograms[i].sum.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		char buf[256];
+		for(unsigned i = 0; i < COUNTERS; ++i) {
+			snprintf(buf, sizeof(buf), "# HELP %s %s\n# TYPE %s counter\n%s %" PRIu64 "\n",
+				COUNTER_NAME[i], COUNTER_HELP[i], COUNTER_NAME[i], COUNTER_NAME[i], counters[i]);
+			out.append(buf);
+		}
+
+		for(unsigned i = 0; i < HISTOGRAMS; ++i) {
+			const char* name = HISTOGRAM_NAME[i];
+			snprintf(buf, sizeof(buf), "# HELP %s %s\n# TYPE %s histogram\n", name, HISTOGRAM_HELP[i], name);
+			out.append(buf);
+
+			uint64_t count = 0;
+			for(unsigned b = 0; b <= BUCKETS; ++b) {
+				count += buckets[i][b];
+				if(b < BUCKETS) {
+					const double bound = double(HISTOGRAM_BASE[i] << b) * HISTOGRAM_UNIT[i];
+					snprintf(buf, sizeof(buf), "%s_bucket{le=\"%g\"} %" PRIu64 "\n", name, bound, count);
+				} else {
+					snprintf(buf, sizeof(buf), "%s_bucket{le=\"+Inf\"} %" PRIu64 "\n", name, count);
+				}
+				out.append(buf);
+			}
+			snprintf(buf, sizeof(buf), "%s_sum %g\n%s_count %" PRIu64 "\n", name, double(sums[i]) * HISTOGRAM_UNIT[i], name, count);
+			out.append(buf);
+		}
+	}
+
+private:
+
+#define NNS_METRICS_NAME(NAME, STR, ...) STR,
+#define NNS_METRICS_HELP(NAME, STR, HELP, ...) HELP,
+#define NNS_METRICS_UNIT(NAME, STR, HELP, UNIT, BASE) UNIT,
+#define NNS_METRICS_BASE(NAME, STR, HELP, UNIT, BASE) BASE,
+
+	static constexpr const char* COUNTER_NAME[] = {NNS_COUNTER_LIST(NNS_METRICS_NAME)};
+	static constexpr const char* COUNTER_HELP[] = {NNS_COUNTER_LIST(NNS_METRICS_HELP)};
+	static constexpr const char* HISTOGRAM_NAME[] = {NNS_HISTOGRAM_LIST(NNS_METRICS_NAME)};
+	static constexpr const char* HISTOGRAM_HELP[] = {NNS_HISTOGRAM_LIST(NNS_METRICS_HELP)};
+	static constexpr double HISTOGRAM_UNIT[] = {NNS_HISTOGRAM_LIST(NNS_METRICS_UNIT)};
+	static constexpr uint64_t HISTOGRAM_BASE[] = {NNS_HISTOGRAM_LIST(NNS_METRICS_BASE)};
+
+#undef NNS_METRICS_NAME
+#undef NNS_METRICS_HELP
+#undef NNS_METRICS_UNIT
+#undef NNS_METRICS_BASE
+
+	static Metrics& instance() {
+		static Metrics metrics;
+		return metrics;
+	}
+
+	static Shard& shard() {
+		static thread_local ThreadShard local;
+		return *local.shard;
+	}
+
+	/**
+	 * Only the owner thread writes, so a relaxed load and store make an atomic add.
+	 */
+	static void increment(Value_t& value, const uint64_t n) {
+		value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @return The index of the first bucket with the upper bound not below @value.
+	 */
+	static unsigned bucket(const uint64_t value, const uint64_t base) {
+		if(value <= base) {
+			return 0;
+		}
+		const auto result = unsigned(64 - __builtin_clzll((value - 1u) / base));
+		return result < BUCKETS ? result : BUCKETS;
+	}
+
+	Shard* attach() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(not _free.empty()) {
+			Shard* result = _free.back();
+			_free.pop_back();
+			return result;
+		}
+		_shards.push_back(std::make_unique<Shard>());
+		return _shards.back().get();
+	}
+
+	void detach(Shard* shard) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_free.push_back(shard);
+	}
+
+};
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "Metrics.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Publishes the metrics in the background : a file rewritten on an interval,
+ * or an HTTP endpoint on a port of 127.0.0.1 for a Prometheus scraper.
+ *
+ * The file is written aside and renamed, so a reader never sees a partial one.
+ */
+class MetricsExporter {
+
+	static constexpr int POLL_MS = 200;
+
+	std::string _path;
+	int _listen = -1;
+	std::chrono::milliseconds _interval{0};
+
+	std::thread _thread;
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	bool _stop = false;
+	std::string _error;
+
+public:
+
+	MetricsExporter() = default;
+	MetricsExporter(const MetricsExporter&) = delete;
+	MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+	~MetricsExporter() {
+		stop();
+	}
+
+	/**
+	 * Starts serving on the port if @target is a number, writing the file every @interval_ms otherwise.
+	 */
+	bool start(const std::string& target, const unsigned interval_ms) {
+		char* end = nullptr;
+		const unsigned long port = strtoul(target.c_str(), &end, 10);
+		if(not target.empty() && *end == '\0') {
+			if(port == 0 || port > 65535u) {
+				_error = "bad port";
+				return false;
+			}
+			if(not listen(uint16_t(port))) {
+				return false;
+			}
+			_thread = std::thread([this] { serve(); });
+			return true;
+		}
+
+		_path = target;
+		_interval = std::chrono::milliseconds(interval_ms);
+		if(not write_file()) {
+			return false;
+		}
+		_thread = std::thread([this] { publish(); });
+		return true;
+	}
+
+	/**
+	 * Stops the thread, the file gets the final values.
+	 */
+	void stop() {
+		if(not _thread.joinable()) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stop = true;
+		}
+		_wake.notify_all();
+		_thread.join();
+
+		if(_listen >= 0) {
+			close(_listen);
+			_listen = -1;
+		} else if(not write_file()) {
+			fprintf(stderr, "Can not write the metrics : %s\n", _error.c_str());
+		}
+	}
+
+	const std::string& error() const {
+		return _error;
+	}
+
+private:
+
+	bool stopped() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _stop;
+	}
+
+	void publish() {
+		std::unique_lock<std::mutex> lock(_mutex);
+		while(not _wake.wait_for(lock, _interval, [this] { return _stop; })) {
+			lock.unlock();
+			if(not write_file()) {
+				fprintf(stderr, "Can not write the metrics : %s\n", _error.c_str());
+			}
+			lock.lock();
+		}
+	}
+
+	bool write_file() {
+		std::string text;
+		Metrics::write(text);
+
+		const std::string tmp = _path + ".tmp";
+		FILE* file = fopen(tmp.c_str(), "w");
+		if(file == nullptr) {
+			_error = tmp + " : " + strerror(errno);
+			return false;
+		}
+		bool result = fwrite(text.data(), 1, text.size(), file) == text.size();
+		result = (fclose(file) == 0) && result;
+		result = result && rename(tmp.c_str(), _path.c_str()) == 0;
+		if(not result) {
+			_error = _path + " : " + strerror(errno);
+		}
+		return result;
+	}
+
+	bool listen(const uint16_t port) {
+		_listen = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if(_listen < 0) {
+			_error = std::string("socket : ") + strerror(errno);
+			return false;
+		}
+		const int yes = 1;
+		setsockopt(_listen, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if(bind(_listen, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(_listen, 8) != 0) {
+			_error = std::string("bind : ") + strerror(errno);
+			close(_listen);
+			_listen = -1;
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Answers every connection with the metrics, the request itself is not parsed.
+	 */
+	void serve() {
+		pollfd pfd{_listen, POLLIN, 0};
+		while(not stopped()) {
+			if(poll(&pfd, 1, POLL_MS) <= 0) {
+				continue;
+			}
+			const int client = accept4(_listen, nullptr, nullptr, SOCK_CLOEXEC);
+			if(client < 0) {
+				continue;
+			}
+
+			// Wait briefly for the request, so the client does not get a reset.
+			pollfd cfd{client, POLLIN, 0};
+			char request[1024];
+			if(poll(&cfd, 1, POLL_MS) > 0) {
+				const ssize_t ignored = recv(client, request, sizeof(request), MSG_DONTWAIT);
+				(void)ignored;
+			}
+
+			std::string body;
+			Metrics::write(body);
+			char head[128];
+			const int len = snprintf(head, sizeof(head),
+				"HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n\r\n", body.size());
+			std::string response(head, size_t(len));
+			response.append(body);
+
+			size_t sent = 0;
+			while(sent < response.size()) {
+				const ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+				if(n <= 0) {
+					break;
+				}
+				sent += size_t(n);
+			}
+			close(client);
+		}
+	}
+
+};
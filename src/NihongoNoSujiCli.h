@@ -1,55 +1,91 @@
 #pragma once
 
 #include "AppCli.h"
+#include "Distractors.h"
+#include "Lexicon.h"
+#include "Number.h"
+#include "ProfileStore.h"
 
 #include <cstdint>
 #include <string>
 
 struct NihongoNoSujiCli {
 
-	enum EnumMethod : unsigned {
-		LEARN,
-		TEST,
-		__SIZE
-	};
-
-	struct EnumMethodToCStr {
-		static const char* to_cstr(const EnumMethod& value) {
-			switch(value) {
-				case EnumMethod::LEARN: return "learn";
-				case EnumMethod::TEST: return "test";
-				default: return "[UNKNOWN]";
-			}
-		}
-	};
+#define NNS_METHOD_LIST(X) \
+	X(LEARN, "learn") \
+	X(TEST, "test") \
+	X(SIMULATE, "simulate") \
+	X(BENCH, "bench") \
+	X(EXPORT, "export") \
+	X(IMPORT, "import") \
+	X(LOOKUP, "lookup")
+
+	ENUM_DECLARE(enum, EnumMethod, unsigned, NNS_METHOD_LIST);
 
 	using Method = EnumField<EnumMethod, EnumMethodToCStr>;
 
-	enum class EnumMode : unsigned {
-		DIGITS,
-		NUMBERS,
-		TIME,
-		__SIZE
-	};
-
-	struct EnumModeToCStr {
-		static const char* to_cstr(const EnumMode& value) {
-			switch(value) {
-				case EnumMode::DIGITS: return "digits";
-				case EnumMode::NUMBERS: return "numbers";
-				case EnumMode::TIME: return "time";
-				default: return "[UNKNOWN]";
-			}
-		}
-	};
+#define NNS_MODE_LIST(X) \
+	X(DIGITS, "digits") \
+	X(NUMBERS, "numbers") \
+	X(TIME, "time") \
+	X(WORDS, "words") \
+	X(DECIMALS, "decimals") \
+	X(NEGATIVES, "negatives") \
+	X(FRACTIONS, "fractions") \
+	X(MONEY, "money")
+
+	ENUM_DECLARE(enum class, EnumMode, unsigned, NNS_MODE_LIST);
 
 	using Mode = EnumField<EnumMode, EnumModeToCStr>;
 
+#define NNS_SCRIPT_LIST(X) \
+	X(CORRECT, "correct") \
+	X(RANDOM, "random") \
+	X(FILE, "file")
+
+	ENUM_DECLARE(enum class, EnumScript, unsigned, NNS_SCRIPT_LIST);
+
+	using Script = EnumField<EnumScript, EnumScriptToCStr>;
+
+#define NNS_BENCH_LIST(X) \
+	X(ROMAJI, "romaji") \
+	X(FILTER, "filter") \
+	X(INDEX, "index") \
+	X(METRICS, "metrics") \
+	X(DISTRACTORS, "distractors") \
+	X(DEADLINE, "deadline") \
+	X(SCRIPT, "script")
+
+	ENUM_DECLARE(enum class, EnumBench, unsigned, NNS_BENCH_LIST);
+
+	using Bench = EnumField<EnumBench, EnumBenchToCStr>;
+
+#define NNS_FORMAT_LIST(X) \
+	X(CSV, "csv") \
+	X(TSV, "tsv") \
+	X(ANKI, "anki")
+
+	ENUM_DECLARE(enum class, EnumFormat, unsigned, NNS_FORMAT_LIST);
+
+	using Format = EnumField<EnumFormat, EnumFormatToCStr>;
+
+#define NNS_NUMERAL_STYLE_LIST(X) \
+	X(KANJI, "kanji") \
+	X(DAIJI, "daiji") \
+	X(POSITIONAL, "positional") \
+	X(MIXED, "mixed")
+
+	ENUM_DECLARE(enum class, EnumNumeralStyle, unsigned, NNS_NUMERAL_STYLE_LIST);
+
+	using NumeralStyle = EnumField<EnumNumeralStyle, EnumNumeralStyleToCStr>;
+
+	static constexpr unsigned NUMBERS_MAX_WIDTH = 12u;
+
 	unsigned pr = 1;
 	Option<Mode> mode = Option<Mode>('M', Mode::description(), ++pr);
 	Option<unsigned> rounds = Option<unsigned>('r', "Rounds.", ++pr);
-	Option<unsigned> digits_from = Option<unsigned>('f', "Digits from. (max 9 for numbers mode)", ++pr);
-	Option<unsigned> digits_to = Option<unsigned>('t', "Digits to. (max 9 for numbers mode)", ++pr);
+	Option<unsigned> digits_from = Option<unsigned>('f', "Digits from. (max 12 when read as a whole, 19 for digits mode)", ++pr);
+	Option<unsigned> digits_to = Option<unsigned>('t', "Digits to. (max 12 when read as a whole, 19 for digits mode)", ++pr);
 
 	OptionFlag show_kanji_before = OptionFlag('j', "Show kanji before.", ++pr);
 	OptionFlag show_kanji_after = OptionFlag('J', "Show kanji after.", ++pr);
@@ -63,7 +99,46 @@ struct NihongoNoSujiCli {
 	OptionFlag play_audio_before = OptionFlag('p', "Play audio before.", ++pr);
 	OptionFlag play_audio_after = OptionFlag('P', "Play audio after.", ++pr);
 
+	Option<NumeralStyle> numeral_style = Option<NumeralStyle>('Y', "Kanji numerals of the numbers mode : 千二百, 大字 壱千弐百, 一二〇〇 or 1200. " + NumeralStyle::description(), ++pr, EnumNumeralStyle::KANJI);
+
 	OptionFlag wait_for_user = OptionFlag('w', "Wait for user before the next question.", ++pr);
+	OptionFlag pregenerate = OptionFlag('b', "Prepare the next rounds in background.", ++pr);
+	OptionFlag kana_answer = OptionFlag('H', "Answer in kana, romaji is transliterated. All the common readings are accepted.", ++pr);
+	Option<unsigned> choices = Option<unsigned>('C', "Multiple choice : the kanji or kana before are shown with N close wrong choices, the answer is the number of the right one. (numbers and money modes, max 8)", ++pr);
+	Option<unsigned> deadline = Option<unsigned>('T', "Speed drill : the answer is due in N ms, a late one is wrong. The deadline shrinks as the answers get faster.", ++pr);
+
+	Option<uint64_t> seed = Option<uint64_t>('s', "Random seed. (the current time by default)", ++pr);
+	Option<std::string> record_file = Option<std::string>('o', "Record the session to the file.", ++pr);
+	Option<std::string> replay_file = Option<std::string>('i', "Replay the session from the file at maximum speed.", ++pr);
+	Option<std::string> progress_file = Option<std::string>('g', "Progress file, the answers of every item are counted in it.", ++pr);
+	Option<std::string> checkpoint_file = Option<std::string>('R', "Checkpoint file : an interrupted session is resumed from it, it is removed when the session is completed.", ++pr);
+	Option<unsigned> checkpoint_interval = Option<unsigned>('G', "Rounds between the checkpoints, they are also written on SIGINT, SIGTERM and SIGHUP.", ++pr, 10);
+
+	Option<Script> script = Option<Script>('S', "Answer by script and report the throughput. " + Script::description(), ++pr);
+	Option<double> script_error = Option<double>('e', "Probability of a wrong answer for the random script and the simulation.", ++pr, 0.1);
+	Option<std::string> script_file = Option<std::string>('I', "Answers for the file script, one per line.", ++pr);
+
+	Option<std::string> profile_file = Option<std::string>('c', "Profile file.", ++pr);
+	Option<std::string> profile_name = Option<std::string>('n', "Profile name, the command line options take precedence.", ++pr);
+
+	Option<unsigned> threads = Option<unsigned>('N', "Simulate from 1 up to N learners in parallel. (0 for one per core)", ++pr, 0);
+	Option<double> latency = Option<double>('l', "Mean answer latency of a simulated learner, ms.", ++pr, 2000);
+
+	Option<Bench> bench = Option<Bench>('B', "Benchmark. " + Bench::description(), ++pr);
+
+	Option<std::string> metrics = Option<std::string>('E', "Metrics in the Prometheus text format : a file rewritten on the interval or a port of 127.0.0.1 to serve them.", ++pr);
+	Option<unsigned> metrics_interval = Option<unsigned>('U', "Interval of the metrics file, ms.", ++pr, 5000);
+
+	Option<Format> format = Option<Format>('F', "Export format. " + Format::description(), ++pr);
+	Option<std::string> output_file = Option<std::string>('O', "Output file of export and import, the shards are suffixed with .0, .1 ...", ++pr);
+	Option<unsigned> shards = Option<unsigned>('X', "Export to N files in parallel.", ++pr, 1);
+	Option<std::string> dictionary_file = Option<std::string>('d', "Dictionary files for the words mode, comma separated. (n5.dic ... n1.dic give the levels)", ++pr);
+	Option<std::string> words_filter = Option<std::string>('W', "Words filter, comma separated, '-' excludes. (n5 ... n1, noun, verb, adj-i, adj-na, adverb, common, mastered, deck0 ... deck7)", ++pr);
+	Option<std::string> query = Option<std::string>('q', "Words of a meaning to look up, all of them must match.", ++pr);
+	Option<double> fuzzy = Option<double>('y', "Typos allowed in a meaning per character of the meaning, the words mode.", ++pr, 0.2);
+
+	Option<std::string> jmdict_file = Option<std::string>('x', "JMdict XML file to import into a dictionary file.", ++pr);
+	Option<std::string> language = Option<std::string>('L', "Language of the imported glosses, ISO 639-2. (eng, rus, ger ...)", ++pr, "eng");
 
 	AppCliMethod<Method> action;
 
@@ -78,9 +153,28 @@ struct NihongoNoSujiCli {
 				show_kana_after,
 				show_arabic_before,
 				show_arabic_after,
+				numeral_style,
 				play_audio_before,
 				play_audio_after,
-				wait_for_user
+				wait_for_user,
+				pregenerate,
+				kana_answer,
+				dictionary_file,
+				words_filter,
+				fuzzy,
+				seed,
+				record_file,
+				replay_file,
+				progress_file,
+				checkpoint_file,
+				checkpoint_interval,
+				script,
+				script_error,
+				script_file,
+				profile_file,
+				profile_name,
+				metrics,
+				metrics_interval
 			);
 
 		action[EnumMethod::TEST]
@@ -93,23 +187,221 @@ struct NihongoNoSujiCli {
 				show_kana_after,
 				show_arabic_before,
 				show_arabic_after,
+				numeral_style,
+				play_audio_before,
+				play_audio_after,
+				wait_for_user,
+				pregenerate,
+				kana_answer,
+				choices,
+				deadline,
+				dictionary_file,
+				words_filter,
+				fuzzy,
+				seed,
+				record_file,
+				replay_file,
+				progress_file,
+				checkpoint_file,
+				checkpoint_interval,
+				script,
+				script_error,
+				script_file,
+				profile_file,
+				profile_name,
+				metrics,
+				metrics_interval
+			);
+
+		action[EnumMethod::SIMULATE]
+			.desc("Simulating learners.")
+			.mand(mode, rounds, digits_from, digits_to)
+			.opt(
+				show_kanji_before,
+				show_kanji_after,
+				show_kana_before,
+				show_kana_after,
+				show_arabic_before,
+				show_arabic_after,
+				numeral_style,
 				play_audio_before,
 				play_audio_after,
-				wait_for_user
+				pregenerate,
+				kana_answer,
+				deadline,
+				dictionary_file,
+				words_filter,
+				fuzzy,
+				seed,
+				script_error,
+				threads,
+				latency,
+				profile_file,
+				profile_name,
+				metrics,
+				metrics_interval
 			);
 
+		action[EnumMethod::BENCH]
+			.desc("Benchmarking.")
+			.mand(bench, rounds)
+			.opt(seed, words_filter);
+
+		action[EnumMethod::EXPORT]
+			.desc("Exporting flashcards.")
+			.mand(mode, format, output_file)
+			.opt(
+				rounds,
+				digits_from,
+				digits_to,
+				numeral_style,
+				dictionary_file,
+				words_filter,
+				shards,
+				seed,
+				profile_file,
+				profile_name
+			);
+
+		action[EnumMethod::IMPORT]
+			.desc("Importing JMdict.")
+			.mand(jmdict_file, output_file)
+			.opt(language);
+
+		action[EnumMethod::LOOKUP]
+			.desc("Looking up words by meaning.")
+			.mand(dictionary_file, query)
+			.opt(profile_file, profile_name);
+
 		action.finalize();
 	}
 
 	bool parse_args(int argc, char** argv) {
-		return action.parse_args(argc, argv) && validate();
+		bool result = action.parse_argv(argc, argv);
+		if(result && profile_name.presented()) {
+			result = apply_profile();
+		}
+		return result && action.validate_args() && validate();
+	}
+
+	bool apply_profile() {
+		if(not profile_file.presented()) {
+			fprintf(stderr, "Profile file is not presented.\n");
+			return false;
+		}
+
+		ProfileStore store;
+		if(not store.load(profile_file.value().c_str())) {
+			fprintf(stderr, "Can not load '%s' : %s\n", profile_file.value().c_str(), store.error().c_str());
+			return false;
+		}
+
+		const std::string_view* options = store.find(profile_name.value());
+		if(options == nullptr) {
+			fprintf(stderr, "Profile '%s' is not found.\n", profile_name.value().c_str());
+			return false;
+		}
+
+		return action.parse_options(*options);
 	}
 
 	bool validate() const {
-		bool result = true;
+		switch(action.action().get()) {
+			case EnumMethod::BENCH:
+				return rounds.value() > 0 && validate_filter();
+
+			case EnumMethod::EXPORT:
+				return validate_export();
+
+			case EnumMethod::IMPORT:
+				return not language.value().empty();
+
+			case EnumMethod::LOOKUP:
+				return true;
+
+			default:
+				return validate_session();
+		}
+	}
+
+	bool validate_session() const {
+		bool result = validate_filter();
+		result = result && (mode.value() != EnumMode::WORDS || (dictionary_file.presented() && not kana_answer.presented()));
+		result = result && fuzzy.value() >= 0 && fuzzy.value() < 1;
 		result = result && digits_from.value() > 0;
 		result = result && digits_from.value() <= digits_to.value();
+		result = result && digits_to.value() <= max_width();
 		result = result && (show_kanji_before.presented() || show_kana_before.presented() || show_arabic_before.presented() || play_audio_before.presented());
+		result = result && not (record_file.presented() && replay_file.presented());
+		result = result && not (script.presented() && replay_file.presented());
+		result = result && not (progress_file.presented() && replay_file.presented());
+		result = result && not (checkpoint_file.presented() && replay_file.presented());
+		result = result && checkpoint_interval.value() > 0;
+		result = result && script_error.value() >= 0 && script_error.value() < 1;
+		result = result && (script.value() != EnumScript::FILE || script_file.presented());
+		result = result && latency.value() >= 0;
+		result = result && metrics_interval.value() > 0;
+		result = result && (not choices.presented() || validate_choices());
+		result = result && (not deadline.presented() || deadline.value() > 0);
+		return result;
+	}
+
+	/**
+	 * The prompt is the arabic or the audio, the choices are the kanji or the kana.
+	 */
+	bool validate_choices() const {
+		bool result = choices.value() > 0 && choices.value() <= Distractors::MAX_COUNT;
+		result = result && (mode.value() == EnumMode::NUMBERS || mode.value() == EnumMode::MONEY);
+		result = result && (show_arabic_before.presented() || play_audio_before.presented());
+		result = result && (show_kanji_before.presented() || show_kana_before.presented());
+		result = result && not kana_answer.presented();
+		return result;
+	}
+
+	/**
+	 * The numbers read as a whole stop before 兆.
+	 */
+	unsigned max_width() const {
+		switch(mode.value().get()) {
+			case EnumMode::NUMBERS:
+			case EnumMode::DECIMALS:
+			case EnumMode::NEGATIVES:
+			case EnumMode::FRACTIONS:
+			case EnumMode::MONEY:
+				return NUMBERS_MAX_WIDTH;
+
+			default:
+				return Number::MAX_WIDTH;
+		}
+	}
+
+	bool validate_filter() const {
+		Lexicon::Filter filter;
+		if(words_filter.presented() && not filter.parse(words_filter.value())) {
+			fprintf(stderr, "Can not parse the words filter '%s'.\n", words_filter.value().c_str());
+			return false;
+		}
+		return true;
+	}
+
+	bool validate_export() const {
+		bool result = shards.value() > 0 && validate_filter();
+		switch(mode.value().get()) {
+			case EnumMode::WORDS:
+				result = result && dictionary_file.presented();
+				break;
+
+			case EnumMode::TIME:
+				result = result && rounds.presented();
+				break;
+
+			default:
+				result = result && rounds.presented() && digits_from.presented() && digits_to.presented();
+				result = result && digits_from.value() > 0;
+				result = result && digits_from.value() <= digits_to.value();
+				result = result && digits_to.value() <= max_width();
+				break;
+		}
 		return result;
 	}
 
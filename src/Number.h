@@ -0,0 +1,191 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * A non-negative number of a fixed width, the leading zeros are a part of the number.
+ * The decomposition only divides by constants, which compile to multiplications.
+ */
+struct Number {
+
+	static constexpr unsigned MAX_WIDTH = 19u;
+
+	static constexpr uint64_t POW10[MAX_WIDTH + 1u] = {
+		1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+		10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+		1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull,
+		10000000000000000000ull
+	};
+
+	/**
+	 * Digits most significant first.
+	 */
+	struct Digits {
+		std::array<uint8_t, MAX_WIDTH> data;
+		unsigned width;
+
+		const uint8_t& operator[](const size_t idx) const {
+			return data[idx];
+		}
+
+		size_t size() const {
+			return width;
+		}
+
+		const uint8_t* begin() const {
+			return data.data();
+		}
+
+		const uint8_t* end() const {
+			return data.data() + width;
+		}
+	};
+
+	/**
+	 * Groups of four digits (一, 万, 億, 兆 ...) least significant first.
+	 */
+	struct Groups {
+		std::array<uint16_t, (MAX_WIDTH + 3u) / 4u> data;
+		unsigned size;
+	};
+
+	uint64_t value = 0;
+	uint8_t width = 0;
+
+	constexpr Number() = default;
+
+	constexpr Number(const uint64_t _value, const unsigned _width) : value(_value), width(uint8_t(_width)) {}
+
+	/**
+	 * @return The number of significant digits, zero has one.
+	 */
+	constexpr unsigned significant() const {
+		unsigned result = 1;
+		while(result < MAX_WIDTH && value >= POW10[result]) {
+			++result;
+		}
+		return result;
+	}
+
+	constexpr unsigned leading_zeros() const {
+		const unsigned sig = significant();
+		return width > sig ? width - sig : 0u;
+	}
+
+	Digits digits() const {
+		Digits result;
+		result.width = width;
+		uint64_t rest = value;
+		unsigned idx = width;
+		while(idx >= 2u) {
+			const auto pair = unsigned(rest % 100u);
+			rest /= 100u;
+			result.data[--idx] = DIGIT_PAIRS[pair][1];
+			result.data[--idx] = DIGIT_PAIRS[pair][0];
+		}
+		if(idx > 0) {
+			result.data[0] = uint8_t(rest % 10u);
+		}
+		return result;
+	}
+
+	Groups groups() const {
+		Groups result{};
+		uint64_t rest = value;
+		do {
+			result.data[result.size++] = uint16_t(rest % 10000u);
+			rest /= 10000u;
+		} while(rest > 0);
+		return result;
+	}
+
+	/**
+	 * @return true if @str consists of exactly the digits of the number, leading zeros included.
+	 */
+	template <typename Char>
+	bool matches(const std::basic_string_view<Char>& str) const {
+		if(str.size() != width) {
+			return false;
+		}
+		uint64_t parsed = 0;
+		for(const Char ch : str) {
+			if(ch < Char('0') || ch > Char('9')) {
+				return false;
+			}
+			parsed = parsed * 10u + uint64_t(ch - Char('0'));
+		}
+		return parsed == value;
+	}
+
+	/**
+	 * @return true if @str is the value as a price : "1980", "1,980", "¥1,980", "￥1980" or "1980円".
+	 * The commas are absent or split every group of three digits, a leading zero is only the price 0,
+	 * the yen key of a JIS keyboard may type a backslash. The string is scanned once, nothing is allocated.
+	 */
+	bool matches_price(const std::string_view& str) const {
+		std::string_view rest = str;
+		for(const std::string_view yen : {"¥", "￥", "\\"}) {
+			if(rest.substr(0, yen.size()) == yen) {
+				rest.remove_prefix(yen.size());
+				break;
+			}
+		}
+		const std::string_view suffix = "円";
+		if(rest.size() >= suffix.size() && rest.substr(rest.size() - suffix.size()) == suffix) {
+			rest.remove_suffix(suffix.size());
+		}
+
+		uint64_t parsed = 0;
+		unsigned digits = 0;
+		unsigned group = 0;
+		bool commas = false;
+		for(const char ch : rest) {
+			if(ch == ',') {
+				if(group == 0 || group > 3u || (commas && group != 3u)) {
+					return false;
+				}
+				commas = true;
+				group = 0;
+			} else if(ch >= '0' && ch <= '9') {
+				// "01980" or "0,980".
+				if(digits == 1u && parsed == 0) {
+					return false;
+				}
+				if(++digits >= MAX_WIDTH) {
+					return false;
+				}
+				++group;
+				parsed = parsed * 10u + uint64_t(ch - '0');
+			} else {
+				return false;
+			}
+		}
+		return digits > 0 && (not commas || group == 3u) && parsed == value;
+	}
+
+	bool operator==(const Number& rv) const {
+		return value == rv.value && width == rv.width;
+	}
+
+	bool operator!=(const Number& rv) const {
+		return not operator==(rv);
+	}
+
+private:
+
+	static constexpr uint8_t DIGIT_PAIRS[100][2] = {
+		{0,0},{0,1},{0,2},{0,3},{0,4},{0,5},{0,6},{0,7},{0,8},{0,9},
+		{1,0},{1,1},{1,2},{1,3},{1,4},{1,5},{1,6},{1,7},{1,8},{1,9},
+		{2,0},{2,1},{2,2},{2,3},{2,4},{2,5},{2,6},{2,7},{2,8},{2,9},
+		{3,0},{3,1},{3,2},{3,3},{3,4},{3,5},{3,6},{3,7},{3,8},{3,9},
+		{4,0},{4,1},{4,2},{4,3},{4,4},{4,5},{4,6},{4,7},{4,8},{4,9},
+		{5,0},{5,1},{5,2},{5,3},{5,4},{5,5},{5,6},{5,7},{5,8},{5,9},
+		{6,0},{6,1},{6,2},{6,3},{6,4},{6,5},{6,6},{6,7},{6,8},{6,9},
+		{7,0},{7,1},{7,2},{7,3},{7,4},{7,5},{7,6},{7,7},{7,8},{7,9},
+		{8,0},{8,1},{8,2},{8,3},{8,4},{8,5},{8,6},{8,7},{8,8},{8,9},
+		{9,0},{9,1},{9,2},{9,3},{9,4},{9,5},{9,6},{9,7},{9,8},{9,9}
+	};
+
+};
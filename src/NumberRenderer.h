@@ -0,0 +1,624 @@
+#pragma once
+
+#include "Number.h"
+#include "Quantity.h"
+#include "ReadingLattice.h"
+
+#include <string>
+
+/**
+ * Japanese renderings of numbers and times : kanji, hiragana, arabic digits
+ * and the lattices of all the acceptable kana readings.
+ */
+struct NumberRenderer {
+
+	using String_t = std::u32string;
+
+	static constexpr const char32_t* DIGIT_MAP_ARABIC_SEP[] = {U"0 ", U"1 ", U"2 ", U"3 ", U"4 ", U"5 ", U"6 ", U"7 ", U"8 ", U"9 "};
+	static constexpr const char32_t* DIGIT_MAP_ARABIC[] = {U"0", U"1", U"2", U"3", U"4", U"5", U"6", U"7", U"8", U"9"};
+	static constexpr const char32_t* DIGIT_MAP_HIRAGANA[] = {U"れい", U"いち", U"に", U"さん", U"よん", U"ご", U"ろく", U"なな", U"はち", U"きゅう"};
+	static constexpr const char32_t* DIGIT_MAP_KANJI[] = {U"0", U"一", U"二", U"三", U"四", U"五", U"六", U"七", U"八", U"九"};
+
+	using Variants_t = ReadingLattice::Variants_t;
+
+	static constexpr Variants_t READING_DIGIT[] = {{"れい", "ゼロ", "まる"}, {"いち"}, {"に"}, {"さん"}, {"よん", "し"}, {"ご"}, {"ろく"}, {"なな", "しち"}, {"はち"}, {"きゅう", "く"}};
+	static constexpr Variants_t READING_TENS[] = {{}, {}, {"に"}, {"さん"}, {"よん", "し"}, {"ご"}, {"ろく"}, {"なな", "しち"}, {"はち"}, {"きゅう"}};
+	static constexpr Variants_t READING_HUNDREDS[] = {{}, {"ひゃく"}, {"にひゃく"}, {"さんびゃく"}, {"よんひゃく"}, {"ごひゃく"}, {"ろっぴゃく"}, {"ななひゃく", "しちひゃく"}, {"はっぴゃく"}, {"きゅうひゃく"}};
+	static constexpr Variants_t READING_THOUSANDS[] = {{}, {"せん", "いっせん"}, {"にせん"}, {"さんぜん"}, {"よんせん"}, {"ごせん"}, {"ろくせん"}, {"ななせん", "しちせん"}, {"はっせん"}, {"きゅうせん"}};
+	static constexpr Variants_t READING_MYRIADS[] = {{}, {"いち"}, {"に"}, {"さん"}, {"よん"}, {"ご"}, {"ろく"}, {"なな", "しち"}, {"はち"}, {"きゅう"}};
+	static constexpr Variants_t READING_HOURS[] = {{"れい", "ゼロ"}, {"いち"}, {"に"}, {"さん"}, {"よ"}, {"ご"}, {"ろく"}, {"しち", "なな"}, {"はち"}, {"く"}, {"じゅう"}, {"じゅういち"}};
+	// The last digit before the point : 一点五 is いってんご.
+	static constexpr Variants_t READING_POINT[] = {{"てん"}, {"いってん", "いちてん"}, {"にてん"}, {"さんてん"}, {"よんてん"}, {"ごてん"}, {"ろくてん", "ろってん"}, {"ななてん", "しちてん"}, {"はってん", "はちてん"}, {"きゅうてん"}};
+	static constexpr Variants_t READING_ZERO_POINT = {"れいてん", "ゼロてん"};
+	static constexpr Variants_t READING_MINUS = {"まいなす", "マイナス"};
+	static constexpr const char32_t* POINT_HIRAGANA[] = {U"てん", U"いってん", U"にてん", U"さんてん", U"よんてん", U"ごてん", U"ろくてん", U"ななてん", U"はってん", U"きゅうてん"};
+	static constexpr const char32_t* MINUS = U"マイナス";
+	// 四分の三 : the denominator first.
+	static constexpr const char32_t* FRACTION = U"分の";
+
+	// The last digit before 円 : 四円 is よえん.
+	static constexpr Variants_t READING_YEN[] = {{"えん"}, {"いちえん"}, {"にえん"}, {"さんえん"}, {"よえん", "よんえん"}, {"ごえん"}, {"ろくえん"}, {"ななえん", "しちえん"}, {"はちえん"}, {"きゅうえん"}};
+	static constexpr const char32_t* YEN_HIRAGANA[] = {U"えん", U"いちえん", U"にえん", U"さんえん", U"よえん", U"ごえん", U"ろくえん", U"ななえん", U"はちえん", U"きゅうえん"};
+	static constexpr const char32_t* YEN = U"円";
+
+	static constexpr Variants_t READING_MINUTES[] = {{"じゅっぷん", "じっぷん"}, {"いっぷん"}, {"にふん"}, {"さんぷん"}, {"よんぷん"}, {"ごふん"}, {"ろっぷん"}, {"ななふん", "しちふん"}, {"はっぷん", "はちふん"}, {"きゅうふん"}};
+
+	/**
+	 * The numeral styles of write_number(), each one is a compile time policy.
+	 */
+	enum class Layout {
+		// 千二百三十四
+		MULTIPLICATIVE,
+		// 一二三四
+		POSITIONAL,
+		// 1万2340
+		ARABIC_GROUPS
+	};
+
+	struct StyleKanji {
+		static constexpr Layout LAYOUT = Layout::MULTIPLICATIVE;
+		static constexpr const char32_t* DIGITS[] = {U"", U"一", U"二", U"三", U"四", U"五", U"六", U"七", U"八", U"九"};
+		static constexpr const char32_t* UNITS[] = {U"", U"十", U"百", U"千"};
+		static constexpr const char32_t* GROUPS[] = {U"", U"万", U"億", U"兆", U"京"};
+		static constexpr const char32_t* ZERO = U"ゼロ";
+		// 一 before 十, 百 and 千.
+		static constexpr bool EXPLICIT_ONE = false;
+		// The decimals are read digit by digit : 三点一四.
+		static constexpr const char32_t* POINT = U"点";
+		static constexpr const char32_t* DECIMALS[] = {U"〇", U"一", U"二", U"三", U"四", U"五", U"六", U"七", U"八", U"九"};
+	};
+
+	/**
+	 * 大字 of the legal and banking documents : 壱萬弐千参拾.
+	 */
+	struct StyleDaiji {
+		static constexpr Layout LAYOUT = Layout::MULTIPLICATIVE;
+		static constexpr const char32_t* DIGITS[] = {U"", U"壱", U"弐", U"参", U"四", U"五", U"六", U"七", U"八", U"九"};
+		static constexpr const char32_t* UNITS[] = {U"", U"拾", U"百", U"千"};
+		static constexpr const char32_t* GROUPS[] = {U"", U"萬", U"億", U"兆", U"京"};
+		static constexpr const char32_t* ZERO = U"零";
+		static constexpr bool EXPLICIT_ONE = true;
+		static constexpr const char32_t* POINT = U"点";
+		static constexpr const char32_t* DECIMALS[] = {U"零", U"壱", U"弐", U"参", U"四", U"五", U"六", U"七", U"八", U"九"};
+	};
+
+	struct StylePositional {
+		static constexpr Layout LAYOUT = Layout::POSITIONAL;
+		static constexpr const char32_t* DIGITS[] = {U"〇", U"一", U"二", U"三", U"四", U"五", U"六", U"七", U"八", U"九"};
+		static constexpr const char32_t* POINT = U"・";
+		static constexpr const char32_t* const* DECIMALS = DIGITS;
+	};
+
+	/**
+	 * The newspapers : 12万3456.
+	 */
+	struct StyleMixed {
+		static constexpr Layout LAYOUT = Layout::ARABIC_GROUPS;
+		static constexpr const char32_t* GROUPS[] = {U"", U"万", U"億", U"兆", U"京"};
+		static constexpr const char32_t* ZERO = U"0";
+		static constexpr const char32_t* POINT = U".";
+		static constexpr const char32_t* const* DECIMALS = DIGIT_MAP_ARABIC;
+	};
+
+	/**
+	 * Writes the number in the @Style, the groups of four digits are named by Style::GROUPS.
+	 */
+	template <typename Style>
+	static void write_number(const Number& number, String_t& output) {
+		if constexpr(Style::LAYOUT == Layout::POSITIONAL) {
+			write_digits(number, Style::DIGITS, output);
+		} else {
+			const Number::Digits buf = number.digits();
+			const size_t size = buf.size();
+			const size_t begin = output.size();
+
+			for(size_t group = (size + 3u) / 4u; group-- > 0;) {
+				bool any = false;
+				for(size_t pos = 4u; pos-- > 0;) {
+					const size_t exp = group * 4u + pos;
+					if(exp >= size) {
+						continue;
+					}
+					const uint8_t digit = buf[size - exp - 1u];
+
+					if constexpr(Style::LAYOUT == Layout::ARABIC_GROUPS) {
+						if(digit > 0 || any) {
+							output.append(DIGIT_MAP_ARABIC[digit]);
+							any = true;
+						}
+					} else if(digit > 0) {
+						if(pos == 0 || digit > 1 || Style::EXPLICIT_ONE) {
+							output.append(Style::DIGITS[digit]);
+						}
+						output.append(Style::UNITS[pos]);
+						any = true;
+					}
+				}
+				if(any) {
+					output.append(Style::GROUPS[group]);
+				}
+			}
+
+			if(output.size() == begin) {
+				output.append(Style::ZERO);
+			}
+		}
+	}
+
+	/**
+	 * Writes the quantity in the @Style, the integers by write_number() and the decimals digit by digit.
+	 */
+	template <typename Style>
+	static void write_quantity(const Quantity& quantity, String_t& output) {
+		if(quantity.negative) {
+			output.append(MINUS);
+		}
+		switch(quantity.kind) {
+			case Quantity::Kind::DECIMAL:
+				if(quantity.whole.value == 0) {
+					output.append(Style::DECIMALS[0]);
+				} else {
+					write_number<Style>(quantity.whole, output);
+				}
+				output.append(Style::POINT);
+				write_digits(quantity.part, Style::DECIMALS, output);
+				break;
+
+			case Quantity::Kind::FRACTION:
+				write_number<Style>(quantity.part, output);
+				output.append(FRACTION);
+				write_number<Style>(quantity.whole, output);
+				break;
+
+			default:
+				write_number<Style>(quantity.whole, output);
+				break;
+		}
+	}
+
+	static void write_quantity_hiragana(const Quantity& quantity, String_t& output) {
+		if(quantity.negative) {
+			output.append(MINUS);
+		}
+		switch(quantity.kind) {
+			case Quantity::Kind::DECIMAL: {
+				const unsigned last = unsigned(quantity.whole.value % 10u);
+				if(quantity.whole.value == 0) {
+					output.append(U"れい");
+				} else if(quantity.whole.value >= 10u) {
+					write_number_hiragana(Number(quantity.whole.value - last, quantity.whole.width), output);
+				}
+				output.append(POINT_HIRAGANA[last]);
+				write_digits(quantity.part, DIGIT_MAP_HIRAGANA, output);
+				break;
+			}
+
+			case Quantity::Kind::FRACTION:
+				write_number_hiragana(quantity.part, output);
+				output.append(U"ぶんの");
+				write_number_hiragana(quantity.whole, output);
+				break;
+
+			default:
+				write_number_hiragana(quantity.whole, output);
+				break;
+		}
+	}
+
+	/**
+	 * Writes "-5", "3.14" or "3/4" into a string of any character type.
+	 */
+	template <typename S>
+	static void write_quantity_arabic(const Quantity& quantity, S& output) {
+		using Char = typename S::value_type;
+		if(quantity.negative) {
+			output.push_back(Char('-'));
+		}
+		const auto append = [&output](const Number& number) {
+			for(const uint8_t digit : number.digits()) {
+				output.push_back(Char('0' + digit));
+			}
+		};
+		append(quantity.whole);
+		if(quantity.kind == Quantity::Kind::DECIMAL) {
+			output.push_back(Char('.'));
+			append(quantity.part);
+		} else if(quantity.kind == Quantity::Kind::FRACTION) {
+			output.push_back(Char('/'));
+			append(quantity.part);
+		}
+	}
+
+	static void write_quantity_lattice(const Quantity& quantity, ReadingLattice& lattice) {
+		if(quantity.negative) {
+			lattice.add(READING_MINUS);
+		}
+		switch(quantity.kind) {
+			case Quantity::Kind::DECIMAL: {
+				const unsigned last = unsigned(quantity.whole.value % 10u);
+				if(quantity.whole.value == 0) {
+					lattice.add(READING_ZERO_POINT);
+				} else {
+					if(quantity.whole.value >= 10u) {
+						write_number_lattice(Number(quantity.whole.value - last, quantity.whole.width), lattice);
+					}
+					lattice.add(READING_POINT[last]);
+				}
+				write_digits_lattice(quantity.part, lattice);
+				break;
+			}
+
+			case Quantity::Kind::FRACTION:
+				write_number_lattice(quantity.part, lattice);
+				lattice.add("ぶんの");
+				write_number_lattice(quantity.whole, lattice);
+				break;
+
+			default:
+				write_number_lattice(quantity.whole, lattice);
+				break;
+		}
+	}
+
+	static void write_price_hiragana(const Number& amount, String_t& output) {
+		const unsigned last = unsigned(amount.value % 10u);
+		if(amount.value >= 10u) {
+			write_number_hiragana(Number(amount.value - last, amount.width), output);
+		}
+		output.append(YEN_HIRAGANA[last]);
+	}
+
+	/**
+	 * Writes ¥1,980.
+	 */
+	static void write_price_arabic(const Number& amount, String_t& output) {
+		output.push_back(U'¥');
+		const Number::Digits buf = amount.digits();
+		for(size_t idx = 0; idx < buf.size(); ++idx) {
+			if(idx > 0 && (buf.size() - idx) % 3u == 0) {
+				output.push_back(U',');
+			}
+			output.push_back(char32_t(U'0' + buf[idx]));
+		}
+	}
+
+	static void write_price_lattice(const Number& amount, ReadingLattice& lattice) {
+		const unsigned last = unsigned(amount.value % 10u);
+		if(amount.value >= 10u) {
+			write_number_lattice(Number(amount.value - last, amount.width), lattice);
+		}
+		lattice.add(READING_YEN[last]);
+	}
+
+	template <typename M>
+	static void write_digits(const Number& input, const M& map, String_t& output) {
+		for(const auto& item : input.digits()) {
+			output.append(map[item]);
+		}
+	}
+
+	static void write_digits_lattice(const Number& input, ReadingLattice& lattice) {
+		for(const auto& item : input.digits()) {
+			lattice.add(READING_DIGIT[item]);
+		}
+	}
+
+	static void write_number_lattice(const Number& number, ReadingLattice& lattice) {
+		const Number::Digits buf = number.digits();
+		bool has_man = false;
+		bool has_oku = false;
+
+		for(size_t idx = 0; idx < buf.size(); ++idx) {
+			const size_t exp = buf.size() - idx - 1u;
+
+			switch(exp) {
+				case 0u:
+					if(buf[idx] > 0) {
+						lattice.add(READING_DIGIT[buf[idx]]);
+					}
+					break;
+
+				case 1u:
+				case 5u:
+				case 9u:
+					if(buf[idx] > 1) {
+						lattice.add(READING_TENS[buf[idx]]);
+					}
+					if(buf[idx] > 0) {
+						has_man = has_man || exp == 5u;
+						has_oku = has_oku || exp == 9u;
+						lattice.add("じゅう");
+					}
+					break;
+
+				case 2u:
+				case 6u:
+				case 10u:
+					if(buf[idx] > 0) {
+						has_man = has_man || exp == 6u;
+						has_oku = has_oku || exp == 10u;
+						lattice.add(READING_HUNDREDS[buf[idx]]);
+					}
+					break;
+
+				case 3u:
+				case 7u:
+				case 11u:
+					if(buf[idx] > 0) {
+						has_man = has_man || exp == 7u;
+						has_oku = has_oku || exp == 11u;
+						lattice.add(READING_THOUSANDS[buf[idx]]);
+					}
+					break;
+
+				case 4u:
+					if(buf[idx] > 0) {
+						lattice.add(READING_MYRIADS[buf[idx]]);
+					}
+					if(buf[idx] > 0 || has_man) {
+						lattice.add("まん");
+					}
+					break;
+
+				case 8u:
+					if(buf[idx] > 0) {
+						lattice.add(READING_MYRIADS[buf[idx]]);
+					}
+					if(buf[idx] > 0 || has_oku) {
+						lattice.add("おく");
+					}
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		if(lattice.size() == 0) {
+			lattice.add({"ゼロ", "れい"});
+		}
+	}
+
+	static void write_time_kanji(const unsigned hours_24, const unsigned min, std::string& output) {
+		output.append(hours_24 < 12u ? "午前" : "午後");
+		output.append(std::to_string(hours_24 % 12u));
+		output.append("時");
+
+		switch(min) {
+			case 0:
+				break;
+
+			case 30:
+				output.append("半");
+				break;
+
+			default:
+				output.append(std::to_string(min));
+				output.append("分");
+				break;
+		}
+	}
+
+	static void write_time_arabic(const unsigned hours_24, const unsigned min, std::string& output) {
+		output.push_back(char('0' + hours_24 / 10u));
+		output.push_back(char('0' + hours_24 % 10u));
+		output.push_back(':');
+		output.push_back(char('0' + min / 10u));
+		output.push_back(char('0' + min % 10u));
+	}
+
+	static void write_time_lattice(const unsigned hours_24, const unsigned min, ReadingLattice& lattice) {
+		lattice.add(hours_24 < 12u ? "ごぜん" : "ごご");
+		lattice.add(READING_HOURS[hours_24 % 12u]);
+		lattice.add("じ");
+
+		const unsigned tens = min / 10u;
+		const unsigned units = min % 10u;
+		if(min == 30u) {
+			lattice.add({"はん", "さんじゅっぷん", "さんじっぷん"});
+		} else if(tens > 0) {
+			if(tens > 1) {
+				lattice.add(READING_TENS[tens]);
+			}
+			if(units == 0) {
+				lattice.add(READING_MINUTES[0]);
+			} else {
+				lattice.add("じゅう");
+				lattice.add(READING_MINUTES[units]);
+			}
+		} else if(units > 0) {
+			lattice.add(READING_MINUTES[units]);
+		}
+	}
+
+	static void write_number_hiragana(const Number& number, String_t& output) {
+		const Number::Digits buf = number.digits();
+		bool has_man = false;
+		bool has_oku = false;
+
+		for(size_t idx = 0; idx < buf.size(); ++idx) {
+			const size_t exp = buf.size() - idx - 1u;
+			// printf("exp=%zu buf[idx]=%u\n", exp, buf[idx]);
+
+			switch(exp) {
+				case 0u:
+					if(buf[idx] > 0) {
+						output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
+					}
+					break;
+
+				case 1u:
+					if(buf[idx] > 1) {
+						output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
+					}
+					if(buf[idx] > 0) {
+						output.append(U"じゅう");
+					}
+					break;
+
+				case 2u:
+					switch(buf[idx]) {
+						case 1u:
+							output.append(U"ひゃく");
+							break;
+
+						case 2u:
+						case 4u:
+						case 5u:
+						case 7u:
+						case 9u:
+							output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
+							output.append(U"ひゃく");
+							break;
+
+						case 3u:
+							output.append(U"さんびゃく");
+							break;
+
+						case 6u:
+							output.append(U"ろっぴゃく");
+							break;
+
+						case 8u:
+							output.append(U"はっぴゃく");
+							break;
+
+					}
+					break;
+
+				case 3u:
+					switch(buf[idx]) {
+						case 1u:
+							output.append(U"せん");
+							break;
+
+						case 2u:
+						case 4u:
+						case 5u:
+						case 6u:
+						case 7u:
+						case 9u:
+							output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
+							output.append(U"せん");
+							break;
+
+						case 3u:
+							output.append(U"さんぜん");
+							break;
+
+						case 8u:
+							output.append(U"はっせん");
+							break;
+
+					}
+					break;
+
+				case 4u:
+					if(buf[idx] > 0) {
+						output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
+					}
+					if(buf[idx] > 0 || has_man) {
+						output.append(U"まん");
+					}
+					break;
+
+				case 5u:
+				case 9u:
+					if(buf[idx] > 1) {
+						output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
+					}
+					if(buf[idx] > 0) {
+						has_man = has_man || exp == 5u;
+						has_oku = has_oku || exp == 9u;
+						output.append(U"じゅう");
+					}
+					break;
+
+				case 6u:
+				case 10u:
+					if(buf[idx] > 0) {
+						has_man = has_man || exp == 6u;
+						has_oku = has_oku || exp == 10u;
+					}
+
+					switch(buf[idx]) {
+						case 1u:
+							output.append(U"ひゃく");
+							break;
+
+						case 2u:
+						case 4u:
+						case 5u:
+						case 7u:
+						case 9u:
+							output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
+							output.append(U"ひゃく");
+							break;
+
+						case 3u:
+							output.append(U"さんびゃく");
+							break;
+
+						case 6u:
+							output.append(U"ろっぴゃく");
+							break;
+
+						case 8u:
+							output.append(U"はっぴゃく");
+							break;
+					}
+					break;
+
+				case 7u:
+				case 11u:
+					if(buf[idx] > 0) {
+						has_man = has_man || exp == 7u;
+						has_oku = has_oku || exp == 11u;
+					}
+
+					switch(buf[idx]) {
+						case 1u:
+							output.append(U"せん");
+							break;
+
+						case 2u:
+						case 4u:
+						case 5u:
+						case 6u:
+						case 7u:
+						case 9u:
+							output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
+							output.append(U"せん");
+							break;
+
+						case 3u:
+							output.append(U"さんぜん");
+							break;
+
+						case 8u:
+							output.append(U"はっせん");
+							break;
+					}
+
+					break;
+
+				case 8u:
+					if(buf[idx] > 0) {
+						output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
+					}
+					if(buf[idx] > 0 || has_oku) {
+						output.append(U"おく");
+					}
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		if(output.empty()) {
+			output = U"ゼロ";
+		}
+	}
+
+};
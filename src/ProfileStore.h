@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * Named option sets loaded from a profile file.
+ * The file has the dictionary layout, one profile per line :
+ *
+ *   # comment
+ *   alice	; -m test -M numbers -r 50 -f 3 -t 6 -jK -a -P
+ *
+ * The file is read once and the profiles refer to its content,
+ * so a lookup costs one hash of the name.
+ */
+class ProfileStore {
+	std::string _content;
+	std::unordered_map<std::string_view, std::string_view> _profiles;
+	std::string _error;
+
+public:
+
+	ProfileStore() = default;
+	ProfileStore(const ProfileStore&) = delete;
+	ProfileStore& operator=(const ProfileStore&) = delete;
+
+	bool load(const char* path) {
+		_content.clear();
+		_profiles.clear();
+
+		FILE* file = fopen(path, "rb");
+		if(file == nullptr) {
+			_error = "can not open the file";
+			return false;
+		}
+
+		char buf[1u << 16u];
+		size_t len;
+		while((len = fread(buf, 1, sizeof(buf), file)) > 0) {
+			_content.append(buf, len);
+		}
+		fclose(file);
+
+		return index();
+	}
+
+	/**
+	 * @return The options of the profile or nullptr.
+	 */
+	const std::string_view* find(const std::string_view& name) const {
+		const auto it = _profiles.find(name);
+		return it != _profiles.end() ? &it->second : nullptr;
+	}
+
+	size_t size() const {
+		return _profiles.size();
+	}
+
+	const std::string& error() const {
+		return _error;
+	}
+
+private:
+
+	bool index() {
+		const std::string_view content(_content);
+		size_t line_no = 0;
+		size_t pos = 0;
+
+		size_t lines = 0;
+		for(const char ch : content) {
+			lines += (ch == '\n');
+		}
+		_profiles.reserve(lines + 1u);
+
+		while(pos < content.size()) {
+			size_t end = content.find('\n', pos);
+			if(end == std::string_view::npos) {
+				end = content.size();
+			}
+			const std::string_view line = trim(content.substr(pos, end - pos));
+			pos = end + 1u;
+			++line_no;
+
+			if(line.empty() || line[0] == '#') {
+				continue;
+			}
+
+			const size_t sep = line.find(';');
+			if(sep == std::string_view::npos) {
+				_error = "no ';' at line " + std::to_string(line_no);
+				return false;
+			}
+
+			const std::string_view name = trim(line.substr(0, sep));
+			if(name.empty()) {
+				_error = "no name at line " + std::to_string(line_no);
+				return false;
+			}
+
+			if(not _profiles.emplace(name, trim(line.substr(sep + 1u))).second) {
+				_error = "profile '" + std::string(name) + "' is duplicated at line " + std::to_string(line_no);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static std::string_view trim(std::string_view str) {
+		while(not str.empty() && is_space(str.front())) {
+			str.remove_prefix(1);
+		}
+		while(not str.empty() && is_space(str.back())) {
+			str.remove_suffix(1);
+		}
+		return str;
+	}
+
+	static bool is_space(const char ch) {
+		return ch == ' ' || ch == '\t' || ch == '\r';
+	}
+
+};
@@ -0,0 +1,525 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Per-item learner progress in a memory mapped file of fixed-size records.
+ *
+ * The file is :
+ *   page 0          - two header slots, the valid one with the greater generation is in use
+ *   pages 1 ... 16  - the write-ahead log of the last commit
+ *   segments        - open addressing hash tables of records, each twice the previous one
+ *
+ * A new segment is appended when the last one is 3/4 full, the old ones stay in place,
+ * so the file grows without rewriting and opening it costs the same for any size.
+ *
+ * The updates are kept aside until commit() : they are written to the log with the item counts
+ * of the segments and synced, then applied in place and synced, then the log is cleared.
+ * A crash at any point leaves either the old records or a complete log which is applied again
+ * on open. Only the pages of the touched records and log entries are synced, so a commit
+ * costs the same for any size of the file.
+ */
+class ProgressStore {
+public:
+
+	struct Record {
+		uint64_t key;
+		uint32_t attempts;
+		uint32_t correct;
+		uint64_t last_seen;
+		uint16_t streak;
+		uint16_t reserved;
+		uint32_t latency_ms;
+	};
+
+	static_assert(sizeof(Record) == 32u, "Record must be 32 bytes.");
+
+	/**
+	 * @return The key of the item name, never zero.
+	 */
+	static uint64_t key(const std::string_view& name) {
+		uint64_t hash = FNV_OFFSET;
+		for(const char ch : name) {
+			hash ^= uint64_t(uint8_t(ch));
+			hash *= FNV_PRIME;
+		}
+		return hash != 0 ? hash : 1u;
+	}
+
+private:
+
+	static constexpr uint64_t MAGIC = 0x31474f5250534e4eull; // "NNSPROG1"
+	static constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+	static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+	static constexpr size_t PAGE = 4096u;
+	static constexpr size_t HEADER_SLOT = PAGE / 2u;
+	static constexpr size_t WAL_OFFSET = PAGE;
+	static constexpr size_t WAL_SIZE = 16u * PAGE;
+	static constexpr size_t DATA_OFFSET = WAL_OFFSET + WAL_SIZE;
+	static constexpr uint64_t FIRST_CAPACITY = 1024u;
+	static constexpr unsigned MAX_SEGMENTS = 32u;
+
+	// The records this many pages apart are synced by one call.
+	static constexpr uint64_t SYNC_GAP = 16u;
+
+	struct Segment {
+		uint64_t offset;
+		uint64_t capacity;
+		uint64_t count;
+	};
+
+	struct Header {
+		uint64_t magic;
+		uint64_t generation;
+		uint64_t segments;
+		Segment segment[MAX_SEGMENTS];
+		uint64_t checksum;
+	};
+
+	static_assert(sizeof(Header) <= HEADER_SLOT, "Header must fit its slot.");
+
+	struct WalHeader {
+		uint64_t magic;
+		uint64_t count;
+		uint64_t checksum;
+		uint64_t reserved;
+		// The item counts of the segments once the log is applied.
+		uint64_t counts[MAX_SEGMENTS];
+	};
+
+	struct WalEntry {
+		uint64_t offset;
+		Record record;
+	};
+
+	static constexpr size_t WAL_CAPACITY = (WAL_SIZE - sizeof(WalHeader)) / sizeof(WalEntry);
+
+	int _fd = -1;
+	uint8_t* _map = nullptr;
+	size_t _size = 0;
+	// The committed state, the counts do not include the pending items.
+	Header _header{};
+	unsigned _slot = 0;
+	std::unordered_map<uint64_t, Record> _pending;
+	uint64_t _added[MAX_SEGMENTS]{};
+	std::vector<uint64_t> _pages;
+	std::string _error;
+
+public:
+
+	ProgressStore() = default;
+	ProgressStore(const ProgressStore&) = delete;
+	ProgressStore& operator=(const ProgressStore&) = delete;
+
+	~ProgressStore() {
+		close();
+	}
+
+	bool open(const char* path) {
+		close();
+
+		_fd = ::open(path, O_RDWR | O_CREAT, 0644);
+		if(_fd < 0) {
+			return fail("can not open");
+		}
+
+		struct stat st{};
+		if(fstat(_fd, &st) != 0) {
+			return fail("can not stat");
+		}
+
+		if(st.st_size == 0) {
+			return create();
+		}
+
+		if(size_t(st.st_size) < DATA_OFFSET || not map(size_t(st.st_size))) {
+			return fail("not a progress file");
+		}
+
+		if(not load_header()) {
+			return fail("no valid header");
+		}
+
+		return recover();
+	}
+
+	void close() {
+		_pending.clear();
+		std::fill(std::begin(_added), std::end(_added), 0);
+		if(_map != nullptr) {
+			munmap(_map, _size);
+			_map = nullptr;
+			_size = 0;
+		}
+		if(_fd >= 0) {
+			::close(_fd);
+			_fd = -1;
+		}
+	}
+
+	/**
+	 * @return true if the item is known, the pending updates included.
+	 */
+	bool find(const uint64_t key, Record& record) const {
+		uint64_t offset;
+		if(not locate(key, offset) ) {
+			return false;
+		}
+		record = read(offset);
+		return true;
+	}
+
+	/**
+	 * Stores the record until the next commit.
+	 */
+	bool put(const Record& record) {
+		uint64_t offset;
+		if(not locate(record.key, offset)) {
+			uint64_t last = _header.segments - 1u;
+			if((_header.segment[last].count + _added[last] + 1u) * 4u > _header.segment[last].capacity * 3u) {
+				if(not grow()) {
+					return false;
+				}
+				last = _header.segments - 1u;
+			}
+			offset = free_slot(_header.segment[last], record.key);
+			++_added[last];
+		}
+		_pending[offset] = record;
+		return true;
+	}
+
+	/**
+	 * Makes the pending updates durable.
+	 */
+	bool commit() {
+		if(_pending.empty()) {
+			return true;
+		}
+
+		auto it = _pending.begin();
+		while(it != _pending.end()) {
+			// The log, a slot still empty on the disk is a new item.
+			auto* wal = reinterpret_cast<WalHeader*>(_map + WAL_OFFSET);
+			auto* entries = reinterpret_cast<WalEntry*>(_map + WAL_OFFSET + sizeof(WalHeader));
+			for(uint64_t i = 0; i < MAX_SEGMENTS; ++i) {
+				wal->counts[i] = i < _header.segments ? _header.segment[i].count : 0;
+			}
+			bool added = false;
+			size_t count = 0;
+			auto chunk = it;
+			while(chunk != _pending.end() && count < WAL_CAPACITY) {
+				entries[count++] = WalEntry{chunk->first, chunk->second};
+				if(reinterpret_cast<const Record*>(_map + chunk->first)->key == 0) {
+					++wal->counts[segment_of(chunk->first)];
+					added = true;
+				}
+				++chunk;
+			}
+			wal->count = count;
+			wal->checksum = wal_checksum(*wal);
+			wal->magic = MAGIC;
+			if(not sync(WAL_OFFSET, sizeof(WalHeader) + count * sizeof(WalEntry))) {
+				return false;
+			}
+
+			// The records, then the counts.
+			if(not apply(*wal)) {
+				return false;
+			}
+			if(added && not write_counts(*wal)) {
+				return false;
+			}
+
+			wal->count = 0;
+			if(not sync(WAL_OFFSET, sizeof(WalHeader))) {
+				return false;
+			}
+			it = chunk;
+		}
+
+		_pending.clear();
+		std::fill(std::begin(_added), std::end(_added), 0);
+		return true;
+	}
+
+	/**
+	 * @return The number of the items, the pending ones included.
+	 */
+	uint64_t size() const {
+		uint64_t result = 0;
+		for(uint64_t i = 0; i < _header.segments; ++i) {
+			result += _header.segment[i].count + _added[i];
+		}
+		return result;
+	}
+
+	const std::string& error() const {
+		return _error;
+	}
+
+private:
+
+	bool fail(const char* what) {
+		_error = std::string(what) + (errno != 0 ? std::string(" : ") + strerror(errno) : std::string());
+		close();
+		return false;
+	}
+
+	bool map(const size_t size) {
+		if(_map != nullptr) {
+			munmap(_map, _size);
+			_map = nullptr;
+		}
+		void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+		if(data == MAP_FAILED) {
+			return false;
+		}
+		_map = static_cast<uint8_t*>(data);
+		_size = size;
+		return true;
+	}
+
+	bool sync(const size_t offset, const size_t size) {
+		const size_t begin = offset & ~(PAGE - 1u);
+		if(msync(_map + begin, offset + size - begin, MS_SYNC) != 0) {
+			_error = std::string("can not sync : ") + strerror(errno);
+			return false;
+		}
+		return true;
+	}
+
+	bool create() {
+		const size_t size = DATA_OFFSET + FIRST_CAPACITY * sizeof(Record);
+		if(ftruncate(_fd, off_t(size)) != 0 || not map(size)) {
+			return fail("can not create");
+		}
+		_header = Header{};
+		_header.magic = MAGIC;
+		_header.segments = 1;
+		_header.segment[0] = Segment{DATA_OFFSET, FIRST_CAPACITY, 0};
+		_slot = 1;
+		if(not sync(DATA_OFFSET, _size - DATA_OFFSET) || not write_header()) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	bool valid(const Header& header) const {
+		if(header.magic != MAGIC || header.segments == 0 || header.segments > MAX_SEGMENTS) {
+			return false;
+		}
+		if(header.checksum != checksum(&header, offsetof(Header, checksum))) {
+			return false;
+		}
+		for(uint64_t i = 0; i < header.segments; ++i) {
+			const Segment& seg = header.segment[i];
+			if(seg.offset < DATA_OFFSET || seg.offset + seg.capacity * sizeof(Record) > _size) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool load_header() {
+		Header slots[2];
+		memcpy(&slots[0], _map, sizeof(Header));
+		memcpy(&slots[1], _map + HEADER_SLOT, sizeof(Header));
+		const bool valid_0 = valid(slots[0]);
+		const bool valid_1 = valid(slots[1]);
+		if(not (valid_0 || valid_1)) {
+			return false;
+		}
+		_slot = (valid_1 && ((not valid_0) || slots[1].generation > slots[0].generation)) ? 1u : 0u;
+		_header = slots[_slot];
+		return true;
+	}
+
+	/**
+	 * Writes the header into the slot not in use, so a torn write leaves the other one.
+	 */
+	bool write_header() {
+		++_header.generation;
+		_header.checksum = checksum(&_header, offsetof(Header, checksum));
+		_slot ^= 1u;
+		memcpy(_map + _slot * HEADER_SLOT, &_header, sizeof(Header));
+		return sync(0, PAGE);
+	}
+
+	/**
+	 * Applies a complete log left by an interrupted commit.
+	 */
+	bool recover() {
+		auto* wal = reinterpret_cast<WalHeader*>(_map + WAL_OFFSET);
+		if(wal->magic != MAGIC || wal->count == 0 || wal->count > WAL_CAPACITY) {
+			return true;
+		}
+		if(wal->checksum == wal_checksum(*wal)) {
+			if(not apply(*wal) || not write_counts(*wal)) {
+				return fail("can not recover");
+			}
+		}
+		wal->count = 0;
+		return sync(WAL_OFFSET, sizeof(WalHeader)) || fail("can not recover");
+	}
+
+	/**
+	 * Writes the records of the log in place and syncs the pages they are on.
+	 */
+	bool apply(const WalHeader& wal) {
+		const auto* entries = reinterpret_cast<const WalEntry*>(&wal + 1);
+		_pages.clear();
+		for(uint64_t i = 0; i < wal.count; ++i) {
+			if(entries[i].offset < DATA_OFFSET || entries[i].offset + sizeof(Record) > _size) {
+				_error = "log entry out of the file";
+				return false;
+			}
+			memcpy(_map + entries[i].offset, &entries[i].record, sizeof(Record));
+			_pages.push_back(entries[i].offset / PAGE);
+		}
+
+		// The close pages are synced at once.
+		std::sort(_pages.begin(), _pages.end());
+		for(size_t begin = 0; begin < _pages.size();) {
+			size_t end = begin + 1u;
+			while(end < _pages.size() && _pages[end] <= _pages[end - 1u] + SYNC_GAP) {
+				++end;
+			}
+			if(not sync(_pages[begin] * PAGE, (_pages[end - 1u] - _pages[begin] + 1u) * PAGE)) {
+				return false;
+			}
+			begin = end;
+		}
+		return true;
+	}
+
+	/**
+	 * Takes the counts of an applied log into the header.
+	 */
+	bool write_counts(const WalHeader& wal) {
+		for(uint64_t i = 0; i < _header.segments; ++i) {
+			if(wal.counts[i] > _header.segment[i].capacity) {
+				_error = "log count out of the segment";
+				return false;
+			}
+			_header.segment[i].count = wal.counts[i];
+		}
+		return write_header();
+	}
+
+	uint64_t segment_of(const uint64_t offset) const {
+		uint64_t i = _header.segments - 1u;
+		while(i > 0 && offset < _header.segment[i].offset) {
+			--i;
+		}
+		return i;
+	}
+
+	/**
+	 * Appends a segment twice the last one, the new segment is committed at once.
+	 */
+	bool grow() {
+		if(_header.segments == MAX_SEGMENTS) {
+			_error = "too many items";
+			return false;
+		}
+		const Segment& last = _header.segment[_header.segments - 1u];
+		const Segment seg{last.offset + last.capacity * sizeof(Record), last.capacity * 2u, 0};
+		const size_t size = seg.offset + seg.capacity * sizeof(Record);
+
+		if(ftruncate(_fd, off_t(size)) != 0 || not map(size)) {
+			_error = std::string("can not grow : ") + strerror(errno);
+			return false;
+		}
+		// The space may be left by a crash.
+		memset(_map + seg.offset, 0, seg.capacity * sizeof(Record));
+		if(not sync(seg.offset, seg.capacity * sizeof(Record))) {
+			return false;
+		}
+
+		_header.segment[_header.segments++] = seg;
+		return write_header();
+	}
+
+	static uint64_t mix(uint64_t key) {
+		key ^= key >> 33u;
+		key *= 0xff51afd7ed558ccdull;
+		key ^= key >> 33u;
+		return key;
+	}
+
+	Record read(const uint64_t offset) const {
+		const auto it = _pending.find(offset);
+		if(it != _pending.end()) {
+			return it->second;
+		}
+		Record result;
+		memcpy(&result, _map + offset, sizeof(Record));
+		return result;
+	}
+
+	/**
+	 * Looks the key up from the newest segment to the oldest one.
+	 */
+	bool locate(const uint64_t key, uint64_t& offset) const {
+		const uint64_t hash = mix(key);
+		for(uint64_t i = _header.segments; i-- > 0;) {
+			const Segment& seg = _header.segment[i];
+			for(uint64_t probe = 0; probe < seg.capacity; ++probe) {
+				const uint64_t slot_offset = seg.offset + ((hash + probe) & (seg.capacity - 1u)) * sizeof(Record);
+				const uint64_t slot_key = read(slot_offset).key;
+				if(slot_key == key) {
+					offset = slot_offset;
+					return true;
+				}
+				if(slot_key == 0) {
+					break;
+				}
+			}
+		}
+		return false;
+	}
+
+	uint64_t free_slot(const Segment& seg, const uint64_t key) const {
+		const uint64_t hash = mix(key);
+		uint64_t slot_offset = seg.offset;
+		for(uint64_t probe = 0; probe < seg.capacity; ++probe) {
+			slot_offset = seg.offset + ((hash + probe) & (seg.capacity - 1u)) * sizeof(Record);
+			if(read(slot_offset).key == 0) {
+				break;
+			}
+		}
+		return slot_offset;
+	}
+
+	static uint64_t wal_checksum(const WalHeader& wal) {
+		const uint64_t counts = checksum(wal.counts, sizeof(wal.counts));
+		return checksum(&wal + 1, wal.count * sizeof(WalEntry), counts);
+	}
+
+	static uint64_t checksum(const void* data, const size_t size, uint64_t hash = FNV_OFFSET) {
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		for(size_t i = 0; i < size; ++i) {
+			hash ^= bytes[i];
+			hash *= FNV_PRIME;
+		}
+		return hash;
+	}
+
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "Number.h"
+
+#include <cstdint>
+#include <numeric>
+#include <string_view>
+
+/**
+ * A negative number, a decimal or a fraction : マイナス五, 三点一四, 四分の三.
+ */
+struct Quantity {
+
+	enum class Kind : uint8_t {
+		INTEGER,
+		// whole.part
+		DECIMAL,
+		// whole / part
+		FRACTION
+	};
+
+	Kind kind = Kind::INTEGER;
+	bool negative = false;
+
+	// The integer part or the numerator.
+	Number whole;
+
+	// The digits after the point, the leading zeros included, or the denominator.
+	Number part;
+
+	/**
+	 * @return true if @str is an arabic writing of the same value : "-5", "3.14" and "3.140",
+	 * "0.05" and ".05", "3/4" and "6/8". The string is scanned once, nothing is allocated.
+	 */
+	bool matches(const std::string_view& str) const {
+		size_t pos = 0;
+		bool minus = false;
+		if(str.substr(0, 1) == "-") {
+			minus = true;
+			pos = 1;
+		} else if(str.substr(0, 3) == "−") {
+			minus = true;
+			pos = 3;
+		}
+
+		Parsed lhs;
+		if(not parse_integer(str, pos, lhs)) {
+			return false;
+		}
+
+		if(kind == Kind::FRACTION) {
+			Parsed rhs;
+			if(pos >= str.size() || str[pos] != '/' || not parse_integer(str, ++pos, rhs)) {
+				return false;
+			}
+			if(pos != str.size() || lhs.width == 0 || rhs.width == 0 || rhs.value == 0) {
+				return false;
+			}
+			// n / d == whole / part as both are reduced, nothing overflows.
+			reduce(lhs.value, rhs.value);
+			uint64_t numerator = whole.value;
+			uint64_t denominator = part.value;
+			reduce(numerator, denominator);
+			const bool same = lhs.value == numerator && rhs.value == denominator;
+			return same && (minus == negative || whole.value == 0);
+		}
+
+		Parsed decimals;
+		if(pos < str.size() && str[pos] == '.') {
+			if(not parse_decimals(str, ++pos, decimals)) {
+				return false;
+			}
+		}
+		if(pos != str.size() || lhs.width + decimals.width == 0) {
+			return false;
+		}
+
+		Parsed expected{0, 0};
+		if(kind == Kind::DECIMAL) {
+			expected = Parsed{part.value, part.width};
+			strip_zeros(expected);
+		}
+		const bool zero = whole.value == 0 && expected.value == 0;
+		return lhs.value == whole.value && decimals.value == expected.value && decimals.width == expected.width
+			&& (minus == negative || zero);
+	}
+
+private:
+
+	struct Parsed {
+		uint64_t value = 0;
+		unsigned width = 0;
+	};
+
+	static bool is_digit(const char ch) {
+		return ch >= '0' && ch <= '9';
+	}
+
+	/**
+	 * Reads the digits at @pos, the leading zeros do not count.
+	 */
+	static bool parse_integer(const std::string_view& str, size_t& pos, Parsed& result) {
+		unsigned significant = 0;
+		for(; pos < str.size() && is_digit(str[pos]); ++pos) {
+			++result.width;
+			if(result.value == 0 && str[pos] == '0') {
+				continue;
+			}
+			if(++significant >= Number::MAX_WIDTH) {
+				return false;
+			}
+			result.value = result.value * 10u + uint64_t(str[pos] - '0');
+		}
+		return true;
+	}
+
+	/**
+	 * Reads the digits after the point without the trailing zeros.
+	 */
+	static bool parse_decimals(const std::string_view& str, size_t& pos, Parsed& result) {
+		unsigned zeros = 0;
+		for(; pos < str.size() && is_digit(str[pos]); ++pos) {
+			if(str[pos] == '0') {
+				++zeros;
+				continue;
+			}
+			result.width += zeros + 1u;
+			if(result.width >= Number::MAX_WIDTH) {
+				return false;
+			}
+			result.value = result.value * Number::POW10[zeros + 1u] + uint64_t(str[pos] - '0');
+			zeros = 0;
+		}
+		return true;
+	}
+
+	static void reduce(uint64_t& numerator, uint64_t& denominator) {
+		const uint64_t divisor = std::gcd(numerator, denominator);
+		if(divisor > 1u) {
+			numerator /= divisor;
+			denominator /= divisor;
+		}
+	}
+
+	static void strip_zeros(Parsed& parsed) {
+		while(parsed.width > 0 && parsed.value % 10u == 0) {
+			parsed.value /= 10u;
+			--parsed.width;
+		}
+	}
+
+};
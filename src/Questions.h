@@ -0,0 +1,119 @@
+#pragma once
+
+#include "DiceMachine.h"
+#include "Number.h"
+#include "Quantity.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+/**
+ * The random questions of the drills.
+ */
+struct Questions {
+
+	// The prices from 十万円 on are round amounts.
+	static constexpr uint64_t ROUND_PRICE = 100000u;
+
+	/**
+	 * @return A number of @width_from ... @width_to digits without leading zeros.
+	 */
+	static Number number(DiceMachine& dm, const unsigned width_from, const unsigned width_to) {
+		const unsigned width = width_from + unsigned(dm.below(width_to - width_from + 1u));
+		const uint64_t min = Number::POW10[width - 1u];
+		return Number(min + dm.below(Number::POW10[width] - min), width);
+	}
+
+	/**
+	 * A price of @width_from ... @width_to digits, the magnitude is log-uniform and the digits
+	 * look like the shops : ¥1,980, ¥2,999, ¥12,300 or 三万五千円, the large amounts are round : 12億円.
+	 */
+	static Number price(DiceMachine& dm, const unsigned width_from, const unsigned width_to) {
+		const double exp = dm.range_double(double(width_from - 1u), double(width_to));
+		uint64_t value = uint64_t(std::pow(10.0, exp));
+		value = std::clamp(value, Number::POW10[width_from - 1u], Number::POW10[width_to] - 1u);
+
+		// The width is kept : the hundreds are floored and the endings stay below the next hundred.
+		if(value >= ROUND_PRICE) {
+			value = round_down(value, dm.pass(0.5) ? 2u : 3u);
+		} else if(value >= 100u) {
+			switch(dm.below(4)) {
+				case 0:
+					value = value / 100u * 100u + 80u;
+					break;
+
+				case 1:
+					value = value / 100u * 100u + 99u;
+					break;
+
+				case 2:
+					value = round_down(value, 2u);
+					break;
+
+				default:
+					value = round_down(value, 3u);
+					break;
+			}
+		}
+
+		const Number result(value, 1u);
+		return Number(value, result.significant());
+	}
+
+	/**
+	 * A time of the day, the half hours are asked more often.
+	 */
+	static void time(DiceMachine& dm, unsigned& hours, unsigned& min) {
+		hours = std::abs(dm.lrand48() % 24);
+		if(dm.pass(0.1)) {
+			min = 30u;
+		} else {
+			min = std::abs(dm.lrand48() % 60);
+		}
+	}
+
+	/**
+	 * @whole with 1 ... 3 digits after the point, the last one is not zero.
+	 * The integer part is zero once in five : 〇・〇五.
+	 */
+	static Quantity decimal(DiceMachine& dm, const Number& whole) {
+		const unsigned width = 1u + unsigned(dm.below(3));
+		Quantity result;
+		result.kind = Quantity::Kind::DECIMAL;
+		result.whole = dm.pass(0.2) ? Number(0, 1) : whole;
+		result.part = Number(dm.below(Number::POW10[width - 1u]) * 10u + 1u + dm.below(9), width);
+		return result;
+	}
+
+	static Quantity negative(const Number& whole) {
+		Quantity result;
+		result.negative = true;
+		result.whole = whole;
+		return result;
+	}
+
+	/**
+	 * A proper fraction over the @denominator, 1 is raised to 2 : 二分の一.
+	 */
+	static Quantity fraction(DiceMachine& dm, const Number& denominator) {
+		Quantity result;
+		result.kind = Quantity::Kind::FRACTION;
+		result.part = denominator.value > 1u ? denominator : Number(2, 1);
+		const Number numerator(1u + dm.below(result.part.value - 1u), 1u);
+		result.whole = Number(numerator.value, numerator.significant());
+		return result;
+	}
+
+private:
+
+	/**
+	 * Keeps the @significant leading digits.
+	 */
+	static uint64_t round_down(const uint64_t value, const unsigned significant) {
+		const unsigned width = Number(value, 1u).significant();
+		const uint64_t unit = width > significant ? Number::POW10[width - significant] : 1u;
+		return value / unit * unit;
+	}
+
+};
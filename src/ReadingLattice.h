@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+/**
+ * All acceptable readings of a question as a sequence of segments,
+ * each segment is a small set of alternative UTF-8 strings.
+ * The alternatives must have static storage duration.
+ *
+ * An answer is checked by a single pass over the segments keeping the set of
+ * reachable answer positions, so the alternatives are never expanded.
+ */
+class ReadingLattice {
+public:
+
+	static constexpr size_t MAX_SEGMENTS = 64u;
+	static constexpr size_t MAX_ALTERNATIVES = 4u;
+	static constexpr size_t MAX_ANSWER = 512u;
+
+	using Variants_t = std::array<const char*, MAX_ALTERNATIVES>;
+
+private:
+
+	struct Segment {
+		uint8_t size;
+		const char* alt[MAX_ALTERNATIVES];
+		uint8_t len[MAX_ALTERNATIVES];
+	};
+
+	static constexpr size_t WORD_BITS = 64u;
+	static constexpr size_t WORDS = MAX_ANSWER / WORD_BITS;
+
+	using Positions_t = std::array<uint64_t, WORDS>;
+
+	std::array<Segment, MAX_SEGMENTS> _segments;
+	size_t _size = 0;
+
+public:
+
+	void clear() {
+		_size = 0;
+	}
+
+	size_t size() const {
+		return _size;
+	}
+
+	/**
+	 * Appends a segment of the non-null alternatives, the first one is the canonical one.
+	 */
+	ReadingLattice& add(const Variants_t& alts) {
+		assert(_size < MAX_SEGMENTS);
+		Segment& seg = _segments[_size++];
+		seg.size = 0;
+		for(const char* alt : alts) {
+			if(alt != nullptr) {
+				seg.alt[seg.size] = alt;
+				seg.len[seg.size] = uint8_t(strlen(alt));
+				++seg.size;
+			}
+		}
+		return *this;
+	}
+
+	ReadingLattice& add(const char* alt) {
+		return add(Variants_t{alt});
+	}
+
+	/**
+	 * Appends the canonical reading.
+	 */
+	void write_canonical(std::string& out) const {
+		for(size_t i = 0; i < _size; ++i) {
+			out.append(_segments[i].alt[0], _segments[i].len[0]);
+		}
+	}
+
+	bool accepts(const std::string_view& answer) const {
+		if(answer.size() >= MAX_ANSWER) {
+			return false;
+		}
+
+		Positions_t cur{};
+		cur[0] = 1u;
+
+		for(size_t i = 0; i < _size; ++i) {
+			const Segment& seg = _segments[i];
+			Positions_t next{};
+			bool any = false;
+
+			for(size_t word = 0; word < WORDS; ++word) {
+				uint64_t bits = cur[word];
+				while(bits != 0) {
+					const size_t pos = word * WORD_BITS + size_t(__builtin_ctzll(bits));
+					bits &= bits - 1u;
+
+					for(size_t a = 0; a < seg.size; ++a) {
+						const size_t end = pos + seg.len[a];
+						if(end <= answer.size() && memcmp(answer.data() + pos, seg.alt[a], seg.len[a]) == 0) {
+							next[end / WORD_BITS] |= uint64_t(1u) << (end % WORD_BITS);
+							any = true;
+						}
+					}
+				}
+			}
+
+			if(not any) {
+				return false;
+			}
+			cur = next;
+		}
+
+		return (cur[answer.size() / WORD_BITS] >> (answer.size() % WORD_BITS)) & 1u;
+	}
+
+};
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Table driven romaji to hiragana transducer.
+ *
+ * The syllables are compiled into a DFA over ASCII which is walked with the longest match.
+ * On top of it :
+ *   'n' before a consonant, "n'" and "nn" not followed by a vowel give ん,
+ *   so "mannyon" is まんよん (万四) rather than まんにょん,
+ *   a doubled consonant and "tch" give っ,
+ *   '-' gives ー,
+ *   any other byte, UTF-8 kana included, is passed through.
+ */
+class Romaji {
+
+	static constexpr size_t ALPHABET = 128u;
+	static constexpr uint16_t NONE = 0;
+
+	struct Syllable {
+		const char* romaji;
+		const char* kana;
+	};
+
+	static constexpr Syllable SYLLABLES[] = {
+		{"a", "あ"}, {"i", "い"}, {"u", "う"}, {"e", "え"}, {"o", "お"},
+
+		{"ka", "か"}, {"ki", "き"}, {"ku", "く"}, {"ke", "け"}, {"ko", "こ"},
+		{"kya", "きゃ"}, {"kyu", "きゅ"}, {"kyo", "きょ"},
+		{"ga", "が"}, {"gi", "ぎ"}, {"gu", "ぐ"}, {"ge", "げ"}, {"go", "ご"},
+		{"gya", "ぎゃ"}, {"gyu", "ぎゅ"}, {"gyo", "ぎょ"},
+
+		{"sa", "さ"}, {"si", "し"}, {"shi", "し"}, {"su", "す"}, {"se", "せ"}, {"so", "そ"},
+		{"sha", "しゃ"}, {"shu", "しゅ"}, {"she", "しぇ"}, {"sho", "しょ"},
+		{"sya", "しゃ"}, {"syu", "しゅ"}, {"syo", "しょ"},
+		{"za", "ざ"}, {"zi", "じ"}, {"ji", "じ"}, {"zu", "ず"}, {"ze", "ぜ"}, {"zo", "ぞ"},
+		{"ja", "じゃ"}, {"ju", "じゅ"}, {"je", "じぇ"}, {"jo", "じょ"},
+		{"jya", "じゃ"}, {"jyu", "じゅ"}, {"jyo", "じょ"},
+		{"zya", "じゃ"}, {"zyu", "じゅ"}, {"zyo", "じょ"},
+
+		{"ta", "た"}, {"ti", "ち"}, {"chi", "ち"}, {"tu", "つ"}, {"tsu", "つ"}, {"te", "て"}, {"to", "と"},
+		{"cha", "ちゃ"}, {"chu", "ちゅ"}, {"che", "ちぇ"}, {"cho", "ちょ"},
+		{"tya", "ちゃ"}, {"tyu", "ちゅ"}, {"tyo", "ちょ"},
+		{"cya", "ちゃ"}, {"cyu", "ちゅ"}, {"cyo", "ちょ"},
+		{"da", "だ"}, {"di", "ぢ"}, {"du", "づ"}, {"de", "で"}, {"do", "ど"},
+		{"dya", "ぢゃ"}, {"dyu", "ぢゅ"}, {"dyo", "ぢょ"},
+
+		{"na", "な"}, {"ni", "に"}, {"nu", "ぬ"}, {"ne", "ね"}, {"no", "の"},
+		{"nya", "にゃ"}, {"nyu", "にゅ"}, {"nyo", "にょ"},
+
+		{"ha", "は"}, {"hi", "ひ"}, {"hu", "ふ"}, {"fu", "ふ"}, {"he", "へ"}, {"ho", "ほ"},
+		{"hya", "ひゃ"}, {"hyu", "ひゅ"}, {"hyo", "ひょ"},
+		{"fa", "ふぁ"}, {"fi", "ふぃ"}, {"fe", "ふぇ"}, {"fo", "ふぉ"},
+		{"ba", "ば"}, {"bi", "び"}, {"bu", "ぶ"}, {"be", "べ"}, {"bo", "ぼ"},
+		{"bya", "びゃ"}, {"byu", "びゅ"}, {"byo", "びょ"},
+		{"pa", "ぱ"}, {"pi", "ぴ"}, {"pu", "ぷ"}, {"pe", "ぺ"}, {"po", "ぽ"},
+		{"pya", "ぴゃ"}, {"pyu", "ぴゅ"}, {"pyo", "ぴょ"},
+		{"vu", "ゔ"},
+
+		{"ma", "ま"}, {"mi", "み"}, {"mu", "む"}, {"me", "め"}, {"mo", "も"},
+		{"mya", "みゃ"}, {"myu", "みゅ"}, {"myo", "みょ"},
+
+		{"ya", "や"}, {"yu", "ゆ"}, {"yo", "よ"},
+
+		{"ra", "ら"}, {"ri", "り"}, {"ru", "る"}, {"re", "れ"}, {"ro", "ろ"},
+		{"rya", "りゃ"}, {"ryu", "りゅ"}, {"ryo", "りょ"},
+
+		{"wa", "わ"}, {"wo", "を"},
+
+		{"xa", "ぁ"}, {"xi", "ぃ"}, {"xu", "ぅ"}, {"xe", "ぇ"}, {"xo", "ぉ"},
+		{"la", "ぁ"}, {"li", "ぃ"}, {"lu", "ぅ"}, {"le", "ぇ"}, {"lo", "ぉ"},
+		{"xya", "ゃ"}, {"xyu", "ゅ"}, {"xyo", "ょ"},
+		{"lya", "ゃ"}, {"lyu", "ゅ"}, {"lyo", "ょ"},
+		{"xtu", "っ"}, {"xtsu", "っ"}, {"ltu", "っ"}, {"ltsu", "っ"},
+	};
+
+	static constexpr const char* KANA_N = "ん";
+	static constexpr const char* KANA_SOKUON = "っ";
+	static constexpr const char* KANA_LONG = "ー";
+
+	struct State {
+		uint16_t next[ALPHABET];
+		const char* out;
+		uint8_t out_len;
+	};
+
+	std::vector<State> _states;
+
+	Romaji() {
+		_states.emplace_back(State{{}, nullptr, 0});
+		for(const auto& syl : SYLLABLES) {
+			uint16_t state = 0;
+			for(const char* ch = syl.romaji; *ch != '\0'; ++ch) {
+				uint16_t& next = _states[state].next[uint8_t(*ch)];
+				if(next == NONE) {
+					next = uint16_t(_states.size());
+					_states.emplace_back(State{{}, nullptr, 0});
+				}
+				state = _states[state].next[uint8_t(*ch)];
+			}
+			_states[state].out = syl.kana;
+			_states[state].out_len = uint8_t(strlen(syl.kana));
+		}
+	}
+
+	static const Romaji& instance() {
+		static const Romaji romaji;
+		return romaji;
+	}
+
+	static char lower(const char ch) {
+		return (ch >= 'A' && ch <= 'Z') ? char(ch - 'A' + 'a') : ch;
+	}
+
+	static bool is_vowel(const char ch) {
+		return ch == 'a' || ch == 'i' || ch == 'u' || ch == 'e' || ch == 'o';
+	}
+
+	static bool is_consonant(const char ch) {
+		return ch >= 'b' && ch <= 'z' && (not is_vowel(ch));
+	}
+
+public:
+
+	/**
+	 * Appends the hiragana reading of @in to @out.
+	 */
+	static void to_hiragana(const std::string_view& in, std::string& out) {
+		const Romaji& table = instance();
+		const size_t size = in.size();
+		size_t pos = 0;
+
+		auto at = [&in, size](const size_t idx) {
+			return idx < size ? lower(in[idx]) : '\0';
+		};
+
+		while(pos < size) {
+			const char ch = at(pos);
+
+			if(uint8_t(ch) >= ALPHABET) {
+				out.push_back(in[pos++]);
+				continue;
+			}
+
+			if(ch == '-') {
+				out.append(KANA_LONG);
+				++pos;
+				continue;
+			}
+
+			if(ch == 'n') {
+				const char next = at(pos + 1u);
+				if(next == '\'') {
+					out.append(KANA_N);
+					pos += 2u;
+					continue;
+				}
+				if(next == 'n') {
+					const char after = at(pos + 2u);
+					out.append(KANA_N);
+					pos += is_vowel(after) ? 1u : 2u;
+					continue;
+				}
+				if(not (is_vowel(next) || next == 'y')) {
+					out.append(KANA_N);
+					++pos;
+					continue;
+				}
+			} else if(is_consonant(ch) && (at(pos + 1u) == ch || (ch == 't' && at(pos + 1u) == 'c'))) {
+				out.append(KANA_SOKUON);
+				++pos;
+				continue;
+			}
+
+			// The longest syllable.
+			uint16_t state = 0;
+			const char* match = nullptr;
+			size_t match_len = 0;
+			size_t match_size = 0;
+			for(size_t idx = pos; idx < size; ++idx) {
+				const char cur = at(idx);
+				if(uint8_t(cur) >= ALPHABET) {
+					break;
+				}
+				state = table._states[state].next[uint8_t(cur)];
+				if(state == NONE) {
+					break;
+				}
+				if(table._states[state].out != nullptr) {
+					match = table._states[state].out;
+					match_len = table._states[state].out_len;
+					match_size = idx - pos + 1u;
+				}
+			}
+
+			if(match != nullptr) {
+				out.append(match, match_len);
+				pos += match_size;
+			} else {
+				out.push_back(in[pos++]);
+			}
+		}
+	}
+
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "Console.h"
+#include "DiceMachine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+ * Answers on behalf of the user according to a policy and discards the output.
+ *
+ * The wrong answer of the RANDOM policy is empty, no mode takes it : a typo of the reference
+ * could pass the fuzzy match of the meanings and break the error model.
+ */
+class ScriptConsole : public Console {
+public:
+
+	enum class Policy {
+		CORRECT,
+		RANDOM,
+		FILE
+	};
+
+private:
+
+	const Policy _policy;
+	const double _error_prob;
+	FILE* _answers;
+	std::string _reference;
+
+protected:
+
+	DiceMachine _dm;
+
+private:
+
+	uint64_t _rounds = 0;
+	uint64_t _answers_total = 0;
+	uint64_t _bytes = 0;
+
+public:
+
+	/**
+	 * @param error_prob - the probability of a wrong answer for the RANDOM policy, must be in [0, 1).
+	 * @param answers - the answers one per line for the FILE policy.
+	 */
+	ScriptConsole(const Policy policy, const double error_prob, FILE* answers, const uint64_t seed) :
+		_policy(policy), _error_prob(error_prob), _answers(answers), _dm(seed) {}
+
+	uint64_t rounds() const {
+		return _rounds;
+	}
+
+	uint64_t answers() const {
+		return _answers_total;
+	}
+
+	uint64_t bytes() const {
+		return _bytes;
+	}
+
+	void write(const char*, size_t len) override {
+		_bytes += len;
+	}
+
+	void flush() override {}
+
+	bool read_line(std::string& line) override {
+		bool result = true;
+		switch(_policy) {
+			case Policy::CORRECT:
+				line = _reference;
+				break;
+
+			case Policy::RANDOM:
+				if(_dm.pass(_error_prob)) {
+					line.clear();
+				} else {
+					line = _reference;
+				}
+				break;
+
+			case Policy::FILE:
+				line.clear();
+				int ch;
+				while((ch = getc(_answers)) != EOF && ch != '\n') {
+					line.push_back(char(ch));
+				}
+				result = (ch != EOF) || (not line.empty());
+				break;
+		}
+		_answers_total += result;
+		return result;
+	}
+
+	bool say(const std::string&) override {
+		return true;
+	}
+
+	uint64_t clock_ms() override {
+		using namespace std::chrono;
+		return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+	}
+
+	void question(const std::string& reference) override {
+		_reference = reference;
+		++_rounds;
+	}
+
+};
+
+/**
+ * A virtual learner : answers wrong with the given probability after an
+ * exponentially distributed delay. The delay only advances the console clock.
+ */
+class LearnerConsole : public ScriptConsole {
+	static constexpr uint64_t MAX_LATENCY_FACTOR = 10u;
+
+	const double _latency_ms;
+	uint64_t _clock = 0;
+
+public:
+
+	LearnerConsole(const double error_prob, const double latency_ms, const uint64_t seed) :
+		ScriptConsole(Policy::RANDOM, error_prob, nullptr, seed), _latency_ms(latency_ms) {}
+
+	bool read_line(std::string& line) override {
+		_clock += sample_latency_us() / 1000u;
+		return ScriptConsole::read_line(line);
+	}
+
+	/**
+	 * The learner too slow for the deadline gives no answer.
+	 */
+	Answer read_answer(std::string& line, const uint64_t timeout_us, uint64_t& response_us) override {
+		response_us = sample_latency_us();
+		if(response_us > timeout_us) {
+			response_us = timeout_us;
+			_clock += timeout_us / 1000u;
+			line.clear();
+			return Answer::TIMEOUT;
+		}
+		_clock += response_us / 1000u;
+		return ScriptConsole::read_line(line) ? Answer::LINE : Answer::OVER;
+	}
+
+	uint64_t clock_ms() override {
+		return _clock;
+	}
+
+private:
+
+	/**
+	 * An exponential latency, capped.
+	 */
+	uint64_t sample_latency_us() {
+		const double latency = -_latency_ms * std::log(1.0 - _dm.drand48());
+		return std::min(uint64_t(latency), uint64_t(_latency_ms) * MAX_LATENCY_FACTOR) * 1000u;
+	}
+
+};
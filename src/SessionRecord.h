@@ -0,0 +1,356 @@
+#pragma once
+
+#include "Console.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * The session record is a text file of events, one per line :
+ *
+ *   nns-session 2 <seed>
+ *   o <options>         - the options of the drill, a replay with other ones is refused
+ *   q <reference>       - a question has been generated
+ *   a <ms> <line>       - the user has answered
+ *   s <us> <line>       - the user has answered before a deadline, in <us> microseconds
+ *   t <us>              - the deadline has passed
+ *   e <ms>              - the input is over
+ *   c <ms>              - the session has read the clock
+ *   d <digest>          - FNV-1a digest of the whole session output
+ *
+ * Times are relative to the beginning of the session, the response times of s and t are not.
+ */
+struct SessionRecord {
+
+	static constexpr const char* MAGIC = "nns-session";
+	static constexpr unsigned VERSION = 2;
+
+	static constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+	static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+	static uint64_t digest(uint64_t hash, const char* data, size_t len) {
+		for(size_t i = 0; i < len; ++i) {
+			hash ^= uint64_t(uint8_t(data[i]));
+			hash *= FNV_PRIME;
+		}
+		return hash;
+	}
+
+};
+
+/**
+ * Passes everything through to @_con and writes the session record.
+ */
+class SessionRecorder : public Console {
+	Console& _con;
+	FILE* _file;
+	uint64_t _digest;
+	uint64_t _tm_begin;
+
+public:
+
+	SessionRecorder(Console& con, FILE* file, const uint64_t seed, const std::string& drill) :
+		_con(con), _file(file), _digest(SessionRecord::FNV_OFFSET), _tm_begin(con.clock_ms()) {
+		fprintf(_file, "%s %u %" PRIu64 "\n", SessionRecord::MAGIC, SessionRecord::VERSION, seed);
+		fprintf(_file, "o %s\n", drill.c_str());
+	}
+
+	~SessionRecorder() override {
+		fprintf(_file, "d %016" PRIx64 "\n", _digest);
+		fflush(_file);
+	}
+
+	void write(const char* data, size_t len) override {
+		_digest = SessionRecord::digest(_digest, data, len);
+		_con.write(data, len);
+	}
+
+	void flush() override {
+		_con.flush();
+	}
+
+	bool read_line(std::string& line) override {
+		const bool result = _con.read_line(line);
+		const uint64_t tm = _con.clock_ms() - _tm_begin;
+		if(result) {
+			fprintf(_file, "a %" PRIu64 " %s\n", tm, line.c_str());
+		} else {
+			fprintf(_file, "e %" PRIu64 "\n", tm);
+		}
+		return result;
+	}
+
+	Answer read_answer(std::string& line, const uint64_t timeout_us, uint64_t& response_us) override {
+		const Answer result = _con.read_answer(line, timeout_us, response_us);
+		switch(result) {
+			case Answer::LINE:
+				fprintf(_file, "s %" PRIu64 " %s\n", response_us, line.c_str());
+				break;
+
+			case Answer::TIMEOUT:
+				fprintf(_file, "t %" PRIu64 "\n", response_us);
+				break;
+
+			case Answer::OVER:
+				fprintf(_file, "e %" PRIu64 "\n", _con.clock_ms() - _tm_begin);
+				break;
+		}
+		return result;
+	}
+
+	bool say(const std::string& to_say) override {
+		return _con.say(to_say);
+	}
+
+	uint64_t clock_ms() override {
+		const uint64_t tm = _con.clock_ms() - _tm_begin;
+		fprintf(_file, "c %" PRIu64 "\n", tm);
+		return tm;
+	}
+
+	void question(const std::string& reference) override {
+		fprintf(_file, "q %s\n", reference.c_str());
+		_con.question(reference);
+	}
+
+};
+
+/**
+ * Feeds a session record back to the session at maximum speed.
+ * Audio is skipped and the output is only digested.
+ */
+class SessionReplay : public Console {
+
+	struct Event {
+		char type;
+		uint64_t tm;
+		std::string text;
+	};
+
+	std::vector<Event> _events;
+	size_t _pos = 0;
+	uint64_t _seed = 0;
+	std::string _drill;
+	uint64_t _digest_expected = 0;
+	uint64_t _digest = SessionRecord::FNV_OFFSET;
+	unsigned _rounds = 0;
+	bool _diverged = false;
+	std::string _error;
+
+public:
+
+	bool load(const char* path) {
+		FILE* file = fopen(path, "r");
+		if(file == nullptr) {
+			_error = "can not open the file";
+			return false;
+		}
+
+		bool result = true;
+		bool has_options = false;
+		bool has_digest = false;
+		unsigned version = 0;
+		char magic[16] = {};
+		if(fscanf(file, "%15s %u %" SCNu64 "\n", magic, &version, &_seed) != 3 || strcmp(magic, SessionRecord::MAGIC) != 0 || version != SessionRecord::VERSION) {
+			_error = version != 0 && version != SessionRecord::VERSION ? "recorded by another version" : "bad header";
+			result = false;
+		}
+
+		std::string line;
+		int ch = 0;
+		while(result && ch != EOF) {
+			line.clear();
+			while((ch = getc(file)) != EOF && ch != '\n') {
+				line.push_back(char(ch));
+			}
+			if(line.empty()) {
+				continue;
+			}
+			if(not has_options) {
+				has_options = line.compare(0, 2, "o ") == 0;
+				_drill.assign(line, std::min<size_t>(2u, line.size()));
+				if(not has_options) {
+					_error = "no options after the header";
+					result = false;
+				}
+				continue;
+			}
+			result = parse_event(line, has_digest);
+		}
+		fclose(file);
+
+		if(result && (not has_digest)) {
+			_error = "the record is truncated";
+			result = false;
+		}
+		return result;
+	}
+
+	uint64_t seed() const {
+		return _seed;
+	}
+
+	/**
+	 * @return The options of the recorded drill.
+	 */
+	const std::string& drill() const {
+		return _drill;
+	}
+
+	unsigned rounds() const {
+		return _rounds;
+	}
+
+	const std::string& error() const {
+		return _error;
+	}
+
+	/**
+	 * @return true if the session has taken exactly the recorded path and produced the recorded output.
+	 */
+	bool verify() {
+		if(_diverged) {
+			return false;
+		}
+		if(_pos != _events.size()) {
+			_error = "the session has ended before the record";
+			return false;
+		}
+		if(_digest != _digest_expected) {
+			_error = "the output differs";
+			return false;
+		}
+		return true;
+	}
+
+	void write(const char* data, size_t len) override {
+		_digest = SessionRecord::digest(_digest, data, len);
+	}
+
+	void flush() override {}
+
+	bool read_line(std::string& line) override {
+		line.clear();
+		const Event* ev = next("ae");
+		if(ev != nullptr && ev->type == 'a') {
+			line = ev->text;
+			return true;
+		}
+		return false;
+	}
+
+	Answer read_answer(std::string& line, const uint64_t, uint64_t& response_us) override {
+		line.clear();
+		response_us = 0;
+		const Event* ev = next("ste");
+		if(ev == nullptr || ev->type == 'e') {
+			return Answer::OVER;
+		}
+		response_us = ev->tm;
+		if(ev->type == 't') {
+			return Answer::TIMEOUT;
+		}
+		line = ev->text;
+		return Answer::LINE;
+	}
+
+	bool say(const std::string&) override {
+		return true;
+	}
+
+	uint64_t clock_ms() override {
+		const Event* ev = next("c");
+		return ev != nullptr ? ev->tm : 0;
+	}
+
+	void question(const std::string& reference) override {
+		const Event* ev = next("q");
+		if(ev != nullptr) {
+			++_rounds;
+			if(ev->text != reference) {
+				diverge("question '" + reference + "' instead of '" + ev->text + "'");
+			}
+		}
+	}
+
+private:
+
+	bool parse_event(const std::string& line, bool& has_digest) {
+		Event ev{line[0], 0, {}};
+		const char* str = line.c_str() + 1;
+		int consumed = 0;
+
+		switch(ev.type) {
+			case 'q':
+				ev.text = (*str == ' ') ? str + 1 : str;
+				break;
+
+			case 'a':
+			case 's':
+				if(sscanf(str, " %" SCNu64 "%n", &ev.tm, &consumed) != 1) {
+					_error = "bad answer : " + line;
+					return false;
+				}
+				str += consumed;
+				ev.text = (*str == ' ') ? str + 1 : str;
+				break;
+
+			case 'e':
+			case 'c':
+			case 't':
+				if(sscanf(str, " %" SCNu64, &ev.tm) != 1) {
+					_error = "bad event : " + line;
+					return false;
+				}
+				break;
+
+			case 'd':
+				if(sscanf(str, " %" SCNx64, &_digest_expected) != 1) {
+					_error = "bad digest : " + line;
+					return false;
+				}
+				has_digest = true;
+				return true;
+
+			default:
+				_error = "unknown event : " + line;
+				return false;
+		}
+
+		_events.push_back(std::move(ev));
+		return true;
+	}
+
+	/**
+	 * @return The next event if it is one of the @types.
+	 */
+	const Event* next(const char* types) {
+		if(_diverged) {
+			return nullptr;
+		}
+		if(_pos >= _events.size()) {
+			diverge("the record is over");
+			return nullptr;
+		}
+		const Event& ev = _events[_pos];
+		if(strchr(types, ev.type) == nullptr) {
+			diverge(std::string("event '") + types[0] + "' instead of '" + ev.type + "'");
+			return nullptr;
+		}
+		++_pos;
+		return &ev;
+	}
+
+	void diverge(std::string reason) {
+		if(not _diverged) {
+			_diverged = true;
+			_error = "diverged at event " + std::to_string(_pos + 1u) + " : " + reason;
+		}
+	}
+
+};
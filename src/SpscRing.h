@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+/**
+ * Lock-free single-producer/single-consumer ring of @N preallocated items.
+ * The items are filled and read in place, so their buffers are reused.
+ */
+template <typename T, size_t N>
+class SpscRing {
+
+	static_assert(N > 0 && (N & (N - 1u)) == 0, "N must be a power of two.");
+
+	static constexpr size_t CACHE_LINE = 64u;
+
+	std::array<T, N> _items;
+	alignas(CACHE_LINE) std::atomic<size_t> _head{0};
+	alignas(CACHE_LINE) std::atomic<size_t> _tail{0};
+
+public:
+
+	/**
+	 * Producer side.
+	 * @return The item to fill or nullptr if the ring is full.
+	 */
+	T* back() {
+		const size_t tail = _tail.load(std::memory_order_relaxed);
+		if(tail - _head.load(std::memory_order_acquire) == N) {
+			return nullptr;
+		}
+		return &_items[tail & (N - 1u)];
+	}
+
+	/**
+	 * Producer side : makes the item returned by back() visible to the consumer.
+	 */
+	void push() {
+		_tail.store(_tail.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+	}
+
+	/**
+	 * Consumer side.
+	 * @return The oldest item or nullptr if the ring is empty.
+	 */
+	T* front() {
+		const size_t head = _head.load(std::memory_order_relaxed);
+		if(head == _tail.load(std::memory_order_acquire)) {
+			return nullptr;
+		}
+		return &_items[head & (N - 1u)];
+	}
+
+	/**
+	 * Consumer side : gives the item returned by front() back to the producer.
+	 */
+	void pop() {
+		_head.store(_head.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+	}
+
+	/**
+	 * Waiting policy for both sides : spin, then yield, then sleep,
+	 * so a producer waiting for the user does not burn a core.
+	 */
+	static void backoff(unsigned& attempt) {
+		static constexpr unsigned SPINS = 64u;
+		static constexpr unsigned YIELDS = 128u;
+		static constexpr auto SLEEP = std::chrono::microseconds(500);
+
+		if(attempt < SPINS) {
+			// busy wait
+		} else if(attempt < YIELDS) {
+			std::this_thread::yield();
+		} else {
+			std::this_thread::sleep_for(SLEEP);
+		}
+		++attempt;
+	}
+
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+/**
+ * Scoped trace spans, compiled in with the NNS_TRACE definition (the CMake option NNS_TRACE).
+ *
+ * NNS_TRACE_SPAN("name") records the time from the statement to the end of the scope
+ * into a ring of the current thread, the name must be a string literal. At exit the rings
+ * are written as Chrome trace events to NNS_TRACE_FILE, to open in chrome://tracing or Perfetto.
+ * Without NNS_TRACE the macro is an empty statement.
+ */
+
+#if defined(NNS_TRACE)
+
+#include <time.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if not defined(NNS_TRACE_FILE)
+#define NNS_TRACE_FILE "trace.json"
+#endif
+
+class Trace {
+public:
+
+	// The last spans of every thread are kept.
+	static constexpr size_t RING_SIZE = 1u << 16u;
+
+	struct Event {
+		const char* name;
+		uint64_t begin;
+		uint64_t end;
+	};
+
+	class Span {
+		const char* _name;
+		uint64_t _begin;
+
+	public:
+
+		explicit Span(const char* name) : _name(name), _begin(now()) {}
+
+		~Span() {
+			record(_name, _begin, now());
+		}
+	};
+
+private:
+
+	struct Ring {
+		unsigned tid;
+		uint64_t head = 0;
+		std::unique_ptr<Event[]> events{new Event[RING_SIZE]};
+	};
+
+	std::mutex _mutex;
+	std::vector<std::unique_ptr<Ring>> _rings;
+
+public:
+
+	~Trace() {
+		dump(NNS_TRACE_FILE);
+	}
+
+	static uint64_t now() {
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return uint64_t(ts.tv_sec) * 1000000000u + uint64_t(ts.tv_nsec);
+	}
+
+	static void record(const char* name, const uint64_t begin, const uint64_t end) {
+		static thread_local Ring* ring = instance().attach();
+		ring->events[ring->head % RING_SIZE] = Event{name, begin, end};
+		++ring->head;
+	}
+
+private:
+
+	static Trace& instance() {
+		static Trace trace;
+		return trace;
+	}
+
+	Ring* attach() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_rings.push_back(std::make_unique<Ring>());
+		_rings.back()->tid = unsigned(_rings.size());
+		return _rings.back().get();
+	}
+
+	/**
+	 * Writes the trace event format, the timestamps are microseconds since the first span.
+	 */
+	void dump(const char* path) {
+		uint64_t origin = UINT64_MAX;
+		for(const auto& ring : _rings) {
+			const uint64_t begin = ring->head > RING_SIZE ? ring->head - RING_SIZE : 0;
+			for(uint64_t i = begin; i < ring->head; ++i) {
+				origin = std::min(origin, ring->events[i % RING_SIZE].begin);
+			}
+		}
+
+		FILE* file = fopen(path, "w");
+		if(file == nullptr) {
+			fprintf(stderr, "Can not open '%s'\n", path);
+			return;
+		}
+
+		fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+		bool first = true;
+		for(const auto& ring : _rings) {
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+				first ? "" : ",\n", ring->tid, ring->tid);
+			first = false;
+
+			const uint64_t begin = ring->head > RING_SIZE ? ring->head - RING_SIZE : 0;
+			for(uint64_t i = begin; i < ring->head; ++i) {
+				const Event& ev = ring->events[i % RING_SIZE];
+				fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+					ev.name, ring->tid, double(ev.begin - origin) / 1e3, double(ev.end - ev.begin) / 1e3);
+			}
+		}
+		fprintf(file, "\n]}\n");
+
+		if(fclose(file) != 0) {
+			fprintf(stderr, "Can not write '%s'\n", path);
+		}
+	}
+
+};
+
+#define NNS_TRACE_CONCAT_(a, b) a##b
+#define NNS_TRACE_CONCAT(a, b) NNS_TRACE_CONCAT_(a, b)
+#define NNS_TRACE_SPAN(name) const Trace::Span NNS_TRACE_CONCAT(nns_trace_span_, __LINE__)(name)
+
+#else
+
+#define NNS_TRACE_SPAN(name) do {} while(false)
+
+#endif
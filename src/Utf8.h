@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * UTF-8 coding and simple case folding of the Latin and Cyrillic letters.
+ */
+struct Utf8 {
+
+	enum class Script {
+		LATIN,
+		CYRILLIC,
+		DIGIT,
+		OTHER
+	};
+
+	/**
+	 * @return The code point at @pos and moves @pos past it, an invalid byte is returned as is.
+	 */
+	static char32_t decode(const std::string_view& str, size_t& pos) {
+		const auto lead = uint8_t(str[pos]);
+		size_t len;
+		char32_t cp;
+		if(lead < 0x80u) {
+			++pos;
+			return lead;
+		} else if((lead & 0xE0u) == 0xC0u) {
+			len = 2;
+			cp = lead & 0x1Fu;
+		} else if((lead & 0xF0u) == 0xE0u) {
+			len = 3;
+			cp = lead & 0x0Fu;
+		} else if((lead & 0xF8u) == 0xF0u) {
+			len = 4;
+			cp = lead & 0x07u;
+		} else {
+			++pos;
+			return lead;
+		}
+
+		if(pos + len > str.size()) {
+			++pos;
+			return lead;
+		}
+		for(size_t i = 1; i < len; ++i) {
+			const auto next = uint8_t(str[pos + i]);
+			if((next & 0xC0u) != 0x80u) {
+				++pos;
+				return lead;
+			}
+			cp = (cp << 6u) | (next & 0x3Fu);
+		}
+		pos += len;
+		return cp;
+	}
+
+	/**
+	 * Writes up to 4 bytes.
+	 * @return The number of bytes.
+	 */
+	static size_t encode(const char32_t cp, char* out) {
+		if(cp < 0x80u) {
+			out[0] = char(cp);
+			return 1;
+		}
+		if(cp < 0x800u) {
+			out[0] = char(0xC0u | (cp >> 6u));
+			out[1] = char(0x80u | (cp & 0x3Fu));
+			return 2;
+		}
+		if(cp < 0x10000u) {
+			out[0] = char(0xE0u | (cp >> 12u));
+			out[1] = char(0x80u | ((cp >> 6u) & 0x3Fu));
+			out[2] = char(0x80u | (cp & 0x3Fu));
+			return 3;
+		}
+		out[0] = char(0xF0u | (cp >> 18u));
+		out[1] = char(0x80u | ((cp >> 12u) & 0x3Fu));
+		out[2] = char(0x80u | ((cp >> 6u) & 0x3Fu));
+		out[3] = char(0x80u | (cp & 0x3Fu));
+		return 4;
+	}
+
+	static void append(const char32_t cp, std::string& out) {
+		char buf[4];
+		out.append(buf, encode(cp, buf));
+	}
+
+	static void append(const std::u32string& str, std::string& out) {
+		for(const char32_t cp : str) {
+			append(cp, out);
+		}
+	}
+
+	/**
+	 * Lower case of ASCII, Latin-1, Latin Extended-A and Cyrillic, ё is folded to е.
+	 */
+	static char32_t fold(const char32_t cp) {
+		if(cp >= 'A' && cp <= 'Z') {
+			return cp + 0x20u;
+		}
+		if(cp >= 0xC0u && cp <= 0xDEu && cp != 0xD7u) {
+			return cp + 0x20u;
+		}
+		if(cp == 0x178u) {
+			return 0xFFu;
+		}
+		if(cp >= 0x100u && cp <= 0x17Fu && cp != 0x130u && cp != 0x131u && cp != 0x138u && cp != 0x149u && cp != 0x17Fu) {
+			// Latin Extended-A pairs, the odd ones between 0x139 and 0x148 and above 0x178 are the capitals.
+			const bool shifted = (cp >= 0x139u && cp <= 0x148u) || cp >= 0x179u;
+			return ((cp & 1u) == (shifted ? 1u : 0u)) ? cp + 1u : cp;
+		}
+		if(cp >= 0x410u && cp <= 0x42Fu) {
+			return cp + 0x20u;
+		}
+		if(cp == 0x401u || cp == 0x451u) {
+			return 0x435u;
+		}
+		if(cp >= 0x400u && cp <= 0x40Fu) {
+			return cp + 0x50u;
+		}
+		return cp;
+	}
+
+	static Script script(const char32_t cp) {
+		if((cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z')) {
+			return Script::LATIN;
+		}
+		if(cp >= '0' && cp <= '9') {
+			return Script::DIGIT;
+		}
+		if((cp >= 0xC0u && cp <= 0x24Fu && cp != 0xD7u && cp != 0xF7u)) {
+			return Script::LATIN;
+		}
+		if(cp >= 0x400u && cp <= 0x4FFu) {
+			return Script::CYRILLIC;
+		}
+		return Script::OTHER;
+	}
+
+};
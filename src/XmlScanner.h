@@ -0,0 +1,251 @@
+#pragma once
+
+#include "Utf8.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/**
+ * Pull XML scanner over a memory block, the names and the texts refer to the block.
+ *
+ * Enough for data files such as JMdict : the declarations (DOCTYPE with its internal subset),
+ * processing instructions and comments are skipped, a self-closing tag is an OPEN and a CLOSE.
+ * The texts are raw, see unescape().
+ */
+class XmlScanner {
+public:
+
+	enum class Token {
+		OPEN,
+		CLOSE,
+		TEXT,
+		END,
+		ERROR
+	};
+
+private:
+
+	const char* _pos;
+	const char* const _end;
+	std::string_view _name;
+	std::string_view _attributes;
+	std::string_view _text;
+	bool _pending_close = false;
+
+public:
+
+	XmlScanner(const char* data, const size_t size) : _pos(data), _end(data + size) {}
+
+	Token next() {
+		if(_pending_close) {
+			_pending_close = false;
+			return Token::CLOSE;
+		}
+
+		while(_pos < _end) {
+			if(*_pos != '<') {
+				const char* lt = find('<');
+				_text = std::string_view(_pos, size_t(lt - _pos));
+				_pos = lt;
+				return Token::TEXT;
+			}
+
+			if(_pos + 1 < _end && _pos[1] == '?') {
+				if(not skip_past("?>")) {
+					return Token::ERROR;
+				}
+				continue;
+			}
+
+			if(_pos + 1 < _end && _pos[1] == '!') {
+				if(not skip_declaration()) {
+					return Token::ERROR;
+				}
+				continue;
+			}
+
+			const char* gt = find('>');
+			if(gt == _end) {
+				return Token::ERROR;
+			}
+
+			if(_pos[1] == '/') {
+				_name = trim(std::string_view(_pos + 2, size_t(gt - _pos - 2)));
+				_pos = gt + 1;
+				return Token::CLOSE;
+			}
+
+			const char* body = _pos + 1;
+			const char* body_end = gt;
+			if(body_end > body && body_end[-1] == '/') {
+				--body_end;
+				_pending_close = true;
+			}
+			const char* name_end = body;
+			while(name_end < body_end && (not is_space(*name_end))) {
+				++name_end;
+			}
+			_name = std::string_view(body, size_t(name_end - body));
+			_attributes = std::string_view(name_end, size_t(body_end - name_end));
+			_pos = gt + 1;
+			return Token::OPEN;
+		}
+
+		return Token::END;
+	}
+
+	/**
+	 * The current position, where the ERROR is.
+	 */
+	const char* position() const {
+		return _pos;
+	}
+
+	/**
+	 * The element name of OPEN and CLOSE.
+	 */
+	std::string_view name() const {
+		return _name;
+	}
+
+	/**
+	 * The raw text of TEXT.
+	 */
+	std::string_view text() const {
+		return _text;
+	}
+
+	/**
+	 * The raw value of the attribute of the last OPEN or an empty view.
+	 */
+	std::string_view attribute(const std::string_view& attr) const {
+		size_t pos = 0;
+		while((pos = _attributes.find(attr, pos)) != std::string_view::npos) {
+			const size_t eq = pos + attr.size();
+			const bool starts = pos == 0 || is_space(_attributes[pos - 1u]);
+			if(starts && eq + 1u < _attributes.size() && _attributes[eq] == '=') {
+				const char quote = _attributes[eq + 1u];
+				const size_t close = _attributes.find(quote, eq + 2u);
+				if(close != std::string_view::npos) {
+					return _attributes.substr(eq + 2u, close - eq - 2u);
+				}
+			}
+			pos = eq;
+		}
+		return std::string_view();
+	}
+
+	/**
+	 * Calls @append with the pieces of @raw, the predefined and the character references decoded.
+	 * Any other entity reference is passed as is.
+	 */
+	template <typename F>
+	static void unescape(std::string_view raw, F&& append) {
+		size_t amp;
+		while((amp = raw.find('&')) != std::string_view::npos) {
+			const size_t semi = raw.find(';', amp);
+			if(semi == std::string_view::npos) {
+				break;
+			}
+			append(raw.substr(0, amp));
+
+			const std::string_view ref = raw.substr(amp + 1u, semi - amp - 1u);
+			char utf8[4];
+			size_t utf8_len = 0;
+			if(ref == "amp") {
+				append("&");
+			} else if(ref == "lt") {
+				append("<");
+			} else if(ref == "gt") {
+				append(">");
+			} else if(ref == "quot") {
+				append("\"");
+			} else if(ref == "apos") {
+				append("'");
+			} else if(ref.size() > 1u && ref[0] == '#' && (utf8_len = encode_reference(ref, utf8)) > 0) {
+				append(std::string_view(utf8, utf8_len));
+			} else {
+				append(raw.substr(amp, semi - amp + 1u));
+			}
+			raw.remove_prefix(semi + 1u);
+		}
+		append(raw);
+	}
+
+	static std::string_view trim(std::string_view str) {
+		while(not str.empty() && is_space(str.front())) {
+			str.remove_prefix(1);
+		}
+		while(not str.empty() && is_space(str.back())) {
+			str.remove_suffix(1);
+		}
+		return str;
+	}
+
+private:
+
+	static bool is_space(const char ch) {
+		return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+	}
+
+	const char* find(const char ch) const {
+		const void* found = memchr(_pos, ch, size_t(_end - _pos));
+		return found != nullptr ? static_cast<const char*>(found) : _end;
+	}
+
+	bool skip_past(const std::string_view& marker) {
+		const std::string_view rest(_pos, size_t(_end - _pos));
+		const size_t found = rest.find(marker);
+		if(found == std::string_view::npos) {
+			return false;
+		}
+		_pos += found + marker.size();
+		return true;
+	}
+
+	/**
+	 * Skips a comment or a declaration, the internal subset of DOCTYPE included.
+	 */
+	bool skip_declaration() {
+		const std::string_view rest(_pos, size_t(_end - _pos));
+		if(rest.substr(0, 4) == "<!--") {
+			return skip_past("-->");
+		}
+		const size_t gt = rest.find('>');
+		const size_t bracket = rest.find('[');
+		if(bracket < gt) {
+			return skip_past("]>");
+		}
+		if(gt == std::string_view::npos) {
+			return false;
+		}
+		_pos += gt + 1u;
+		return true;
+	}
+
+	static size_t encode_reference(const std::string_view& ref, char* out) {
+		uint32_t cp = 0;
+		const bool hex = ref[1] == 'x' || ref[1] == 'X';
+		for(size_t i = hex ? 2u : 1u; i < ref.size(); ++i) {
+			const char ch = ref[i];
+			uint32_t digit;
+			if(ch >= '0' && ch <= '9') {
+				digit = uint32_t(ch - '0');
+			} else if(hex && ch >= 'a' && ch <= 'f') {
+				digit = uint32_t(ch - 'a' + 10);
+			} else if(hex && ch >= 'A' && ch <= 'F') {
+				digit = uint32_t(ch - 'A' + 10);
+			} else {
+				return 0;
+			}
+			cp = cp * (hex ? 16u : 10u) + digit;
+			if(cp > 0x10FFFFu) {
+				return 0;
+			}
+		}
+
+		return Utf8::encode(cp, out);
+	}
+
+};
@@ -1,47 +1,210 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 using EnumBase_t = int;
 
+#define ENUM_DECLARE_ITEM(item, name) item,
+#define ENUM_DECLARE_NAME(item, name) name,
+
+/**
+ * Declares the enum @Enum and its name converter @Enum##ToCStr from a single list.
+ * @Key is either 'enum' or 'enum class'.
+ * @LIST(X) must expand X(ITEM, "name") for each item, e.g.
+ *
+ *   #define COLOR_LIST(X) X(RED, "red") X(GREEN, "green")
+ *   ENUM_DECLARE(enum class, EnumColor, unsigned, COLOR_LIST);
+ */
+#define ENUM_DECLARE(Key, Enum, Base, LIST) \
+	Key Enum : Base { \
+		LIST(ENUM_DECLARE_ITEM) \
+		__SIZE \
+	}; \
+	struct Enum##ToCStr { \
+		static constexpr const char* const NAMES[] = { LIST(ENUM_DECLARE_NAME) "[UNKNOWN]" }; \
+		static constexpr const char* to_cstr(const Enum& value) { \
+			const auto idx = static_cast<size_t>(value); \
+			return NAMES[idx < static_cast<size_t>(Enum::__SIZE) ? idx : static_cast<size_t>(Enum::__SIZE)]; \
+		} \
+	}
+
+/**
+ * Compile-time alphabetical order of the enum names, E::__SIZE included.
+ */
+template <typename E, typename ToCStr>
+struct EnumNameOrder {
+
+	static constexpr size_t SIZE = static_cast<size_t>(E::__SIZE) + 1u;
+
+	using Table_t = std::array<EnumBase_t, SIZE>;
+
+	static constexpr std::string_view name(const EnumBase_t idx) {
+		return ToCStr::to_cstr(static_cast<E>(idx));
+	}
+
+	static constexpr Table_t build_sorted() {
+		Table_t result{};
+		for(size_t i = 0; i < SIZE; ++i) {
+			result[i] = static_cast<EnumBase_t>(i);
+		}
+		for(size_t i = 1; i < SIZE; ++i) {
+			const EnumBase_t item = result[i];
+			size_t j = i;
+			while(j > 0 && name(item) < name(result[j - 1u])) {
+				result[j] = result[j - 1u];
+				--j;
+			}
+			result[j] = item;
+		}
+		return result;
+	}
+
+	static constexpr Table_t build_rank() {
+		const Table_t sorted = build_sorted();
+		Table_t result{};
+		for(size_t i = 0; i < SIZE; ++i) {
+			result[static_cast<size_t>(sorted[i])] = static_cast<EnumBase_t>(i);
+		}
+		return result;
+	}
+
+	/**
+	 * The values sorted by name.
+	 */
+	static constexpr Table_t SORTED = build_sorted();
+
+	/**
+	 * The position of each value in SORTED.
+	 */
+	static constexpr Table_t RANK = build_rank();
+
+	static constexpr EnumBase_t rank(const E& val) {
+		const auto idx = static_cast<size_t>(val);
+		return RANK[idx < SIZE ? idx : SIZE - 1u];
+	}
+
+};
+
+/**
+ * Compile-time perfect hash of the enum names.
+ * @ToCStr::to_cstr() must be constexpr.
+ */
+template <typename E, typename ToCStr>
+class EnumNameHash {
+
+	static constexpr size_t SIZE = static_cast<size_t>(E::__SIZE);
+
+	static constexpr size_t calc_table_size() {
+		size_t result = 1;
+		while(result < SIZE * 2u) {
+			result <<= 1u;
+		}
+		return result;
+	}
+
+	static constexpr size_t TABLE_SIZE = calc_table_size();
+	static constexpr uint32_t SEED_LIMIT = 1u << 16u;
+
+	static constexpr uint32_t hash(const std::string_view& str, const uint32_t seed) {
+		uint32_t result = 2166136261u ^ seed;
+		for(const char ch : str) {
+			result ^= uint32_t(uint8_t(ch));
+			result *= 16777619u;
+		}
+		return result ^ (result >> 15u);
+	}
+
+	static constexpr uint32_t find_seed() {
+		for(uint32_t seed = 0; seed < SEED_LIMIT; ++seed) {
+			bool used[TABLE_SIZE] = {};
+			bool collision = false;
+			for(size_t i = 0; i < SIZE && (not collision); ++i) {
+				const size_t slot = hash(ToCStr::to_cstr(static_cast<E>(i)), seed) & (TABLE_SIZE - 1u);
+				collision = used[slot];
+				used[slot] = true;
+			}
+			if(not collision) {
+				return seed;
+			}
+		}
+		return SEED_LIMIT;
+	}
+
+	static constexpr uint32_t SEED = find_seed();
+	static_assert(SEED < SEED_LIMIT, "No perfect hash for the enum names.");
+
+	static constexpr std::array<EnumBase_t, TABLE_SIZE> build_table() {
+		std::array<EnumBase_t, TABLE_SIZE> result{};
+		for(auto& item : result) {
+			item = static_cast<EnumBase_t>(SIZE);
+		}
+		for(size_t i = 0; i < SIZE; ++i) {
+			result[hash(ToCStr::to_cstr(static_cast<E>(i)), SEED) & (TABLE_SIZE - 1u)] = static_cast<EnumBase_t>(i);
+		}
+		return result;
+	}
+
+	static constexpr std::array<EnumBase_t, TABLE_SIZE> TABLE = build_table();
+
+public:
+
+	/**
+	 * @return The value named @str or E::__SIZE.
+	 */
+	static E find(const std::string_view& str) {
+		const EnumBase_t idx = TABLE[hash(str, SEED) & (TABLE_SIZE - 1u)];
+		if(idx != static_cast<EnumBase_t>(SIZE) && str == ToCStr::to_cstr(static_cast<E>(idx))) {
+			return static_cast<E>(idx);
+		}
+		return E::__SIZE;
+	}
+
+};
+
 template <typename E, typename ToCStr, bool PedanticRead = true, typename std::enable_if_t<std::is_enum<E>::value, int> = 0>
 struct EnumField {
 	using Enum_t = E;
 	E value;
 
-	EnumField() : value(E::__SIZE) {}
+	constexpr EnumField() : value(E::__SIZE) {}
+
+	constexpr EnumField(const E& val) : value(val) {}
 
-	EnumField(const E& val) : value(val) {}
+	using Order_t = EnumNameOrder<E, ToCStr>;
 
-	bool operator<(const E& val) const {
-		return std::string(to_cstr()) < std::string(ToCStr::to_cstr(val));
+	constexpr bool operator<(const E& val) const {
+		return Order_t::rank(value) < Order_t::rank(val);
 	}
 
-	bool operator<(const EnumField& val) const {
-		return std::string(to_cstr()) < std::string(val.to_cstr());
+	constexpr bool operator<(const EnumField& val) const {
+		return Order_t::rank(value) < Order_t::rank(val.value);
 	}
 
-	bool operator!=(const E& val) const {
+	constexpr bool operator!=(const E& val) const {
 		return value != val;
 	}
 
-	bool operator==(const E& val) const {
+	constexpr bool operator==(const E& val) const {
 		return value == val;
 	}
 
-	bool operator==(const EnumField& val) const {
+	constexpr bool operator==(const EnumField& val) const {
 		return value == val.value;
 	}
 
-	const E& get() const {
+	constexpr const E& get() const {
 		return value;
 	}
 
-	const char* to_cstr() const {
+	constexpr const char* to_cstr() const {
 		return ToCStr::to_cstr(value);
 	}
 
-	static const char* to_cstr(const E& val) {
+	static constexpr const char* to_cstr(const E& val) {
 		return ToCStr::to_cstr(val);
 	}
 
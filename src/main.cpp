@@ -1,734 +1,1576 @@
 #include "NihongoNoSujiCli.h"
+#include "CardWriter.h"
+#include "Checkpoint.h"
+#include "Console.h"
+#include "Deadline.h"
 #include "DiceMachine.h"
+#include "Distractors.h"
+#include "FuzzyMatcher.h"
+#include "GlossIndex.h"
+#include "JmdictImporter.h"
+#include "Lexicon.h"
+#include "Metrics.h"
+#include "MetricsExporter.h"
+#include "Number.h"
+#include "NumberRenderer.h"
+#include "ProgressStore.h"
+#include "Quantity.h"
+#include "Questions.h"
+#include "ReadingLattice.h"
+#include "Romaji.h"
+#include "SpscRing.h"
+#include "ScriptConsole.h"
+#include "SessionRecord.h"
 #include "TermColor.h"
-
+#include "Trace.h"
+#include "Utf8.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
 #include <cstdio>
+#include <ctime>
 #include <vector>
-#include <locale>
-#include <codecvt>
+#include <memory>
+#include <optional>
+#include <thread>
 
 class NihongoNoSuji {
 
-	using String_t = std::u32string;
+	using String_t = NumberRenderer::String_t;
+
+	/**
+	 * A fully prepared round : everything the interactive loop needs to show and check it.
+	 */
+	struct Round {
+		std::string before;
+		std::string after;
+		std::string say_before;
+		std::string say_after;
+		bool say_first = false;
+
+		// Shown on a mistake.
+		std::string expected;
+
+		// Arabic answers are checked by value if there is a number.
+		Number number;
+		bool has_number = false;
+
+		// A price is the number with optional commas, ¥ and 円.
+		bool has_price = false;
+
+		// Or by value if there is a quantity, 3.140 is 3.14.
+		Quantity quantity;
+		bool has_quantity = false;
+
+		// Kana answers are checked against all the acceptable readings.
+		ReadingLattice lattice;
 
-	static constexpr const char32_t* DIGIT_MAP_ARABIC_SEP[] = {U"0 ", U"1 ", U"2 ", U"3 ", U"4 ", U"5 ", U"6 ", U"7 ", U"8 ", U"9 "};
-	static constexpr const char32_t* DIGIT_MAP_ARABIC[] = {U"0", U"1", U"2", U"3", U"4", U"5", U"6", U"7", U"8", U"9"};
-	static constexpr const char32_t* DIGIT_MAP_HIRAGANA[] = {U"れい", U"いち", U"に", U"さん", U"よん", U"ご", U"ろく", U"なな", U"はち", U"きゅう"};
-	static constexpr const char32_t* DIGIT_MAP_KANJI[] = {U"0", U"一", U"二", U"三", U"四", U"五", U"六", U"七", U"八", U"九"};
+		// Meaning answers are checked against the glosses of the word.
+		const Lexicon::Entry* word = nullptr;
 
-	using Buffer_t = std::vector<unsigned char>;
+		// The key of the progress record.
+		uint64_t item = 0;
+
+		// The random stream before the round, a resumed session starts from it.
+		uint64_t rng = 0;
+	};
+
+	using RoundRing_t = SpscRing<Round, 8u>;
 
 	const NihongoNoSujiCli _cli;
+	Console& _con;
 	DiceMachine _dm;
 
+	// The words mode.
+	const Lexicon* _lex = nullptr;
+	std::vector<uint32_t> _words;
+
+	ProgressStore* _progress = nullptr;
+	Checkpoint* _checkpoint = nullptr;
+
+	// The scratch of prepare_round(), which runs on one thread at a time.
+	String_t _text;
+	Distractors _distractors;
+
+	// The numeral style of the numbers mode.
+	using NumberWriter_t = void (*)(const Number&, String_t&);
+	using QuantityWriter_t = void (*)(const Quantity&, String_t&);
+	const NumberWriter_t _write_number_kanji;
+	const QuantityWriter_t _write_quantity_kanji;
+
+	// The speed drill.
+	Deadline _deadline;
+
+	// The wrong answers of the last run().
+	unsigned _mistakes = 0;
+
 public:
-	NihongoNoSuji(const NihongoNoSujiCli& cli) :
-		_cli(cli), _dm(time(nullptr)) {}
 
-	Buffer_t generate_input() {
-		Buffer_t buf;
-		unsigned width = _cli.digits_from + std::abs(_dm.lrand48() / 16) % (_cli.digits_to - _cli.digits_from + 1u);
-		if(width > 0) {
-			--width;
-			buf.push_back((std::abs(_dm.lrand48()) % 9u) + 1u);
-			while(width--) {
-				buf.push_back(std::abs(_dm.lrand48()) % 10u);
-			}
+	// The correct answers in a row making a word mastered.
+	static constexpr uint16_t MASTERED_STREAK = 3u;
+	NihongoNoSuji(const NihongoNoSujiCli& cli, Console& con, const uint64_t seed) :
+		_cli(cli), _con(con), _dm(seed), _write_number_kanji(number_writer(cli.numeral_style.value())),
+		_write_quantity_kanji(quantity_writer(cli.numeral_style.value())),
+		_deadline(cli.deadline.presented() ? uint64_t(cli.deadline.value()) * 1000u : 0) {}
+
+	/**
+	 * The words to drill in the words mode, @lex must outlive the drill.
+	 */
+	void set_words(const Lexicon& lex, const Lexicon::Selection& words) {
+		_lex = &lex;
+		_words.clear();
+		_words.reserve(words.count());
+		words.for_each([this](const size_t idx) {
+			_words.push_back(uint32_t(idx));
+		});
+	}
+
+	static NumberWriter_t number_writer(const NihongoNoSujiCli::NumeralStyle& style) {
+		switch(style.get()) {
+			case NihongoNoSujiCli::EnumNumeralStyle::DAIJI:
+				return NumberRenderer::write_number<NumberRenderer::StyleDaiji>;
+
+			case NihongoNoSujiCli::EnumNumeralStyle::POSITIONAL:
+				return NumberRenderer::write_number<NumberRenderer::StylePositional>;
+
+			case NihongoNoSujiCli::EnumNumeralStyle::MIXED:
+				return NumberRenderer::write_number<NumberRenderer::StyleMixed>;
+
+			default:
+				return NumberRenderer::write_number<NumberRenderer::StyleKanji>;
 		}
-		return buf;
 	}
 
-	void time_generate_input(unsigned& hours, unsigned& min) {
-		hours = std::abs(_dm.lrand48() % 24);
-		if(_dm.pass(0.1)) {
-			min = 30u;
-		} else {
-			min = std::abs(_dm.lrand48() % 60);
+	static QuantityWriter_t quantity_writer(const NihongoNoSujiCli::NumeralStyle& style) {
+		switch(style.get()) {
+			case NihongoNoSujiCli::EnumNumeralStyle::DAIJI:
+				return NumberRenderer::write_quantity<NumberRenderer::StyleDaiji>;
+
+			case NihongoNoSujiCli::EnumNumeralStyle::POSITIONAL:
+				return NumberRenderer::write_quantity<NumberRenderer::StylePositional>;
+
+			case NihongoNoSujiCli::EnumNumeralStyle::MIXED:
+				return NumberRenderer::write_quantity<NumberRenderer::StyleMixed>;
+
+			default:
+				return NumberRenderer::write_quantity<NumberRenderer::StyleKanji>;
 		}
 	}
 
-	void show_before(const Buffer_t& buf) const {
-		String_t question;
+	/**
+	 * Keeps the per-item progress of the checked rounds in @progress.
+	 */
+	void set_progress(ProgressStore& progress) {
+		_progress = &progress;
+	}
+
+	/**
+	 * Resumes the session from @checkpoint and keeps it up to date.
+	 */
+	void set_checkpoint(Checkpoint& checkpoint) {
+		_checkpoint = &checkpoint;
+	}
+
+	/**
+	 * The values of the options shaping the questions and the answers of a session, as a line of options.
+	 */
+	static std::string drill_options(const NihongoNoSujiCli& cli) {
+		char numbers[128];
+		snprintf(numbers, sizeof(numbers), " -r %u -f %u -t %u -C %u -T %u -y %g -Y ", cli.rounds.value(), cli.digits_from.value(),
+			cli.digits_to.value(), cli.choices.presented() ? cli.choices.value() : 0u, cli.deadline.presented() ? cli.deadline.value() : 0u,
+			cli.fuzzy.value());
+
+		std::string drill;
+		drill.append(cli.action.action().to_cstr()).append(" -M ");
+		drill.append(cli.mode.value().to_cstr()).append(numbers);
+		drill.append(cli.numeral_style.value().to_cstr()).append(" -");
+		for(const OptionFlag* flag : {&cli.show_kanji_before, &cli.show_kanji_after, &cli.show_kana_before, &cli.show_kana_after,
+			&cli.show_arabic_before, &cli.show_arabic_after, &cli.play_audio_before, &cli.play_audio_after, &cli.kana_answer,
+			&cli.wait_for_user}) {
+			if(flag->presented()) {
+				drill.push_back(flag->name);
+			}
+		}
+		drill.append(" -d '").append(cli.dictionary_file.value());
+		drill.append("' -W '").append(cli.words_filter.value()).push_back('\'');
+		return drill;
+	}
 
+	static uint64_t drill_fingerprint(const NihongoNoSujiCli& cli) {
+		return Checkpoint::fingerprint(drill_options(cli));
+	}
+
+	unsigned mistakes() const {
+		return _mistakes;
+	}
+
+	static uint64_t word_key(const Lexicon::Entry& word) {
+		std::string name;
+		name.append(word.kanji).push_back('\t');
+		name.append(word.kana);
+		return ProgressStore::key(name);
+	}
+
+	Number generate_input() {
+		NNS_TRACE_SPAN("generate_input");
+		return Questions::number(_dm, _cli.digits_from, _cli.digits_to);
+	}
+
+	Number generate_price() {
+		NNS_TRACE_SPAN("generate_price");
+		return Questions::price(_dm, _cli.digits_from, _cli.digits_to);
+	}
+
+	/**
+	 * A decimal, a negative number or a fraction of generate_input().
+	 */
+	Quantity generate_quantity() {
+		const Number input = generate_input();
 		switch(_cli.mode.value().get()) {
+			case NihongoNoSujiCli::EnumMode::DECIMALS:
+				return Questions::decimal(_dm, input);
 
-			case NihongoNoSujiCli::EnumMode::DIGITS:
-				if(_cli.show_kanji_before.presented()) {
-					write_digits(buf, DIGIT_MAP_KANJI, question);
-				}
+			case NihongoNoSujiCli::EnumMode::FRACTIONS:
+				return Questions::fraction(_dm, input);
 
-				if(_cli.show_kana_before.presented()) {
-					if(not question.empty()) {
-						question.append(U"  ");
-					}
-					write_digits(buf, DIGIT_MAP_HIRAGANA, question);
-				}
+			default:
+				return Questions::negative(input);
+		}
+	}
 
-				if(_cli.show_arabic_before.presented()) {
-					if(not question.empty()) {
-						question.append(U"  ");
-					}
-					write_digits(buf, DIGIT_MAP_ARABIC, question);
-				}
+	static bool is_quantity(const NihongoNoSujiCli::Mode& mode) {
+		return mode == NihongoNoSujiCli::EnumMode::DECIMALS || mode == NihongoNoSujiCli::EnumMode::NEGATIVES
+			|| mode == NihongoNoSujiCli::EnumMode::FRACTIONS;
+	}
 
-				if(_cli.play_audio_before.presented()) {
-					String_t to_say;
-					write_digits(buf, DIGIT_MAP_ARABIC_SEP, to_say);
-					say(to_say);
-				}
-				break;
+	bool checks_answers() const {
+		return _cli.action.action() != NihongoNoSujiCli::EnumMethod::LEARN;
+	}
 
-			case NihongoNoSujiCli::EnumMode::NUMBERS:
-				if(_cli.show_kanji_before.presented()) {
-					write_number_kanji(buf, question);
-				}
+	void time_generate_input(unsigned& hours, unsigned& min) {
+		NNS_TRACE_SPAN("time_generate_input");
+		Questions::time(_dm, hours, min);
+	}
 
-				if(_cli.show_kana_before.presented()) {
-					if(not question.empty()) {
-						question.append(U"  ");
-					}
-					write_number_hiragana(buf, question);
-				}
+	/**
+	 * Generates and renders the next round.
+	 */
+	void prepare_round(Round& round) {
+		NNS_TRACE_SPAN("prepare_round");
+		const auto tm_before = std::chrono::steady_clock::now();
+		round.rng = _dm.state();
+		round.before.clear();
+		round.after.clear();
+		round.say_before.clear();
+		round.say_after.clear();
+		round.expected.clear();
+		round.lattice.clear();
+		round.word = nullptr;
+		round.has_quantity = false;
+		round.has_price = false;
 
-				if(_cli.show_arabic_before.presented()) {
-					if(not question.empty()) {
-						question.append(U"  ");
-					}
-					write_digits(buf, DIGIT_MAP_ARABIC, question);
-				}
+		switch(_cli.mode.value().get()) {
+			case NihongoNoSujiCli::EnumMode::TIME:
+				prepare_time_round(round);
+				break;
 
-				if(_cli.play_audio_before.presented()) {
-					String_t to_say;
-					write_digits(buf, DIGIT_MAP_ARABIC, to_say);
-					say(to_say);
-				}
+			case NihongoNoSujiCli::EnumMode::WORDS:
+				prepare_word_round(round);
+				break;
+
+			case NihongoNoSujiCli::EnumMode::DECIMALS:
+			case NihongoNoSujiCli::EnumMode::NEGATIVES:
+			case NihongoNoSujiCli::EnumMode::FRACTIONS:
+				prepare_quantity_round(round);
+				break;
+
+			case NihongoNoSujiCli::EnumMode::MONEY:
+				prepare_price_round(round);
 				break;
 
 			default:
-				assert(false);
+				prepare_number_round(round);
 				break;
 		}
-		if(not question.empty()) {
-			printf("%s  ", to_basic_string(question).c_str());
+
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tm_before);
+		Metrics::observe(Metrics::RENDER_TIME, uint64_t(elapsed.count()));
+	}
+
+	void prepare_number_round(Round& round) {
+		const Number input = generate_input();
+		round.number = input;
+		round.has_number = true;
+		round.say_first = true;
+
+		char name[32];
+		snprintf(name, sizeof(name), "%s %0*" PRIu64, _cli.mode.value().to_cstr(), int(input.width), input.value);
+		round.item = ProgressStore::key(name);
+
+		// The kanji and kana before are the choices of a multiple choice.
+		const bool choices = _cli.choices.presented();
+		_text.clear();
+		write_question(input, _cli.show_kanji_before.presented() && not choices, _cli.show_kana_before.presented() && not choices, _cli.show_arabic_before.presented(), _text);
+		if(not _text.empty()) {
+			Utf8::append(_text, round.before);
+			round.before.append(choices ? "\n" : "  ");
+		}
+
+		if(_cli.play_audio_before.presented()) {
+			_text.clear();
+			write_audio(input, _text);
+			Utf8::append(_text, round.say_before);
+		}
+
+		_text.clear();
+		write_question(input, _cli.show_kanji_after.presented(), _cli.show_kana_after.presented(), _cli.show_arabic_after.presented(), _text);
+		if(not _text.empty()) {
+			Utf8::append(_text, round.after);
+			round.after.push_back('\n');
+		}
+
+		if(_cli.play_audio_after.presented()) {
+			_text.clear();
+			write_audio(input, _text);
+			Utf8::append(_text, round.say_after);
+		}
+
+		if(_cli.kana_answer.presented()) {
+			if(_cli.mode.value() == NihongoNoSujiCli::EnumMode::NUMBERS) {
+				NumberRenderer::write_number_lattice(input, round.lattice);
+			} else {
+				NumberRenderer::write_digits_lattice(input, round.lattice);
+			}
+			round.lattice.write_canonical(round.expected);
+		} else {
+			_text.clear();
+			NumberRenderer::write_digits(input, NumberRenderer::DIGIT_MAP_ARABIC, _text);
+			Utf8::append(_text, round.expected);
+		}
+
+		if(choices) {
+			prepare_choices(round, input);
 		}
 	}
 
-	void show_after(const Buffer_t& buf) const {
-		String_t question;
+	/**
+	 * Lists the answer among the distractors in the kanji or kana before,
+	 * the expected answer becomes the number of the right choice.
+	 */
+	void prepare_choices(Round& round, const Number& input) {
+		const bool money = _cli.mode.value() == NihongoNoSujiCli::EnumMode::MONEY;
+		const unsigned count = _cli.choices + 1u;
+		std::array<Number, Distractors::MAX_COUNT + 1u> numbers;
+		_distractors.generate(_dm, input, _cli.max_width(), numbers.data(), count - 1u);
+		const unsigned correct = unsigned(_dm.below(count));
+		numbers[count - 1u] = numbers[correct];
+		numbers[correct] = input;
+
+		for(unsigned i = 0; i < count; ++i) {
+			_text.clear();
+			if(money) {
+				write_price_question(numbers[i], _cli.show_kanji_before.presented(), _cli.show_kana_before.presented(), false, _text);
+			} else {
+				write_question(numbers[i], _cli.show_kanji_before.presented(), _cli.show_kana_before.presented(), false, _text);
+			}
+			char label[16];
+			snprintf(label, sizeof(label), "%u) ", i + 1u);
+			round.before.append(label);
+			Utf8::append(_text, round.before);
+			round.before.push_back('\n');
+		}
 
-		switch(_cli.mode.value().get()) {
+		round.has_number = false;
+		round.has_price = false;
+		round.lattice.clear();
+		round.expected = std::to_string(correct + 1u);
+	}
 
-			case NihongoNoSujiCli::EnumMode::DIGITS:
+	/**
+	 * The text is rendered into the buffers of the round, which keep their capacity between the rounds.
+	 */
+	void prepare_quantity_round(Round& round) {
+		const Quantity input = generate_quantity();
+		round.quantity = input;
+		round.has_quantity = true;
+		round.has_number = false;
+		round.say_first = true;
+
+		NumberRenderer::write_quantity_arabic(input, round.expected);
+		char name[64];
+		snprintf(name, sizeof(name), "%s %s", _cli.mode.value().to_cstr(), round.expected.c_str());
+		round.item = ProgressStore::key(name);
+
+		_text.clear();
+		write_quantity_question(input, _cli.show_kanji_before.presented(), _cli.show_kana_before.presented(), _cli.show_arabic_before.presented(), _text);
+		if(not _text.empty()) {
+			Utf8::append(_text, round.before);
+			round.before.append("  ");
+		}
 
-				if(_cli.show_kanji_after.presented()) {
-					write_digits(buf, DIGIT_MAP_KANJI, question);
-				}
+		_text.clear();
+		write_quantity_question(input, _cli.show_kanji_after.presented(), _cli.show_kana_after.presented(), _cli.show_arabic_after.presented(), _text);
+		if(not _text.empty()) {
+			Utf8::append(_text, round.after);
+			round.after.push_back('\n');
+		}
 
-				if(_cli.show_kana_after.presented()) {
-					if(not question.empty()) {
-						question.append(U"  ");
-					}
-					write_digits(buf, DIGIT_MAP_HIRAGANA, question);
-				}
+		// The speech reads the kanji, "3/4" would be a date.
+		if(_cli.play_audio_before.presented() || _cli.play_audio_after.presented()) {
+			_text.clear();
+			NumberRenderer::write_quantity<NumberRenderer::StyleKanji>(input, _text);
+			if(_cli.play_audio_before.presented()) {
+				Utf8::append(_text, round.say_before);
+			}
+			if(_cli.play_audio_after.presented()) {
+				Utf8::append(_text, round.say_after);
+			}
+		}
 
-				if(_cli.show_arabic_after.presented()) {
-					if(not question.empty()) {
-						question.append(U"  ");
-					}
-					write_digits(buf, DIGIT_MAP_ARABIC, question);
-				}
+		if(_cli.kana_answer.presented()) {
+			NumberRenderer::write_quantity_lattice(input, round.lattice);
+			round.expected.clear();
+			round.lattice.write_canonical(round.expected);
+		}
+	}
 
-				if(not question.empty()) {
-					printf("%s\n", to_basic_string(question).c_str());
-					fflush(stdout);
-				}
+	void prepare_price_round(Round& round) {
+		const Number input = generate_price();
+		round.number = input;
+		round.has_price = true;
+		round.has_number = false;
+		round.say_first = true;
+
+		char name[32];
+		snprintf(name, sizeof(name), "money %" PRIu64, input.value);
+		round.item = ProgressStore::key(name);
+
+		const bool choices = _cli.choices.presented();
+		_text.clear();
+		write_price_question(input, _cli.show_kanji_before.presented() && not choices, _cli.show_kana_before.presented() && not choices, _cli.show_arabic_before.presented(), _text);
+		if(not _text.empty()) {
+			Utf8::append(_text, round.before);
+			round.before.append(choices ? "\n" : "  ");
+		}
 
-				if(_cli.play_audio_after.presented()) {
-					String_t to_say;
-					write_digits(buf, DIGIT_MAP_ARABIC_SEP, to_say);
-					say(to_say);
-				}
+		_text.clear();
+		write_price_question(input, _cli.show_kanji_after.presented(), _cli.show_kana_after.presented(), _cli.show_arabic_after.presented(), _text);
+		if(not _text.empty()) {
+			Utf8::append(_text, round.after);
+			round.after.push_back('\n');
+		}
 
-				break;
+		if(_cli.play_audio_before.presented() || _cli.play_audio_after.presented()) {
+			_text.clear();
+			NumberRenderer::write_number<NumberRenderer::StyleKanji>(input, _text);
+			_text.append(NumberRenderer::YEN);
+			if(_cli.play_audio_before.presented()) {
+				Utf8::append(_text, round.say_before);
+			}
+			if(_cli.play_audio_after.presented()) {
+				Utf8::append(_text, round.say_after);
+			}
+		}
 
-			case NihongoNoSujiCli::EnumMode::NUMBERS:
-				if(_cli.show_kanji_after.presented()) {
-					write_number_kanji(buf, question);
-				}
+		if(_cli.kana_answer.presented()) {
+			NumberRenderer::write_price_lattice(input, round.lattice);
+			round.lattice.write_canonical(round.expected);
+		} else {
+			_text.clear();
+			NumberRenderer::write_price_arabic(input, _text);
+			Utf8::append(_text, round.expected);
+		}
 
-				if(_cli.show_kana_after.presented()) {
-					if(not question.empty()) {
-						question.append(U"  ");
-					}
-					write_number_hiragana(buf, question);
-				}
+		if(choices) {
+			prepare_choices(round, input);
+		}
+	}
 
-				if(_cli.show_arabic_after.presented()) {
-					if(not question.empty()) {
-						question.append(U"  ");
-					}
-					write_digits(buf, DIGIT_MAP_ARABIC, question);
-				}
-				if(not question.empty()) {
-					printf("%s\n", to_basic_string(question).c_str());
-					fflush(stdout);
-				}
+	void prepare_time_round(Round& round) {
+		unsigned hours_24 = 0;
+		unsigned min = 0;
+		time_generate_input(hours_24, min);
+		round.has_number = false;
+		round.say_first = false;
 
-				if(_cli.play_audio_after.presented()) {
-					String_t to_say;
-					write_digits(buf, DIGIT_MAP_ARABIC, to_say);
-					say(to_say);
-				}
+		char name[16];
+		snprintf(name, sizeof(name), "time %02u:%02u", hours_24, min);
+		round.item = ProgressStore::key(name);
 
-				break;
+		std::string kanji;
+		std::string arabic;
+		NumberRenderer::write_time_kanji(hours_24, min, kanji);
+		NumberRenderer::write_time_arabic(hours_24, min, arabic);
 
-			default:
-				assert(false);
-				break;
+		if(_cli.show_arabic_before.presented()) {
+			round.before.append(arabic).push_back(' ');
+		}
+		if(_cli.show_kanji_before.presented()) {
+			round.before.append(kanji).push_back(' ');
+		}
+		if(_cli.play_audio_before.presented()) {
+			round.say_before = kanji;
+		}
+
+		if(_cli.show_arabic_after.presented()) {
+			round.after.append(arabic).push_back(' ');
+		}
+		if(_cli.show_kanji_after.presented()) {
+			round.after.append(kanji).push_back(' ');
+		}
+		if(_cli.play_audio_after.presented()) {
+			round.say_after = kanji;
 		}
 
+		if(_cli.kana_answer.presented()) {
+			NumberRenderer::write_time_lattice(hours_24, min, round.lattice);
+			round.lattice.write_canonical(round.expected);
+		} else {
+			round.expected = arabic;
+		}
 	}
 
-	void run() {
-		auto tm_before = time(nullptr);
+	void prepare_word_round(Round& round) {
+		const Lexicon::Entry& word = (*_lex)[_words[_dm.below(_words.size())]];
+		round.word = &word;
+		round.item = word_key(word);
+		round.has_number = false;
+		round.say_first = false;
 
-		const unsigned rounds_total = _cli.rounds;
-		unsigned rounds_left = _cli.rounds;
-		unsigned mistakes = 0;
-		while(rounds_left--) {
+		write_word(word, _cli.show_kanji_before.presented(), _cli.show_kana_before.presented(), _cli.show_arabic_before.presented(), round.before);
+		if(not round.before.empty()) {
+			round.before.append("  ");
+		}
+		if(_cli.play_audio_before.presented()) {
+			round.say_before = word.kana;
+		}
 
-			if(_cli.mode.value().get() == NihongoNoSujiCli::EnumMode::TIME) {
+		write_word(word, _cli.show_kanji_after.presented(), _cli.show_kana_after.presented(), _cli.show_arabic_after.presented(), round.after);
+		if(not round.after.empty()) {
+			round.after.push_back('\n');
+		}
+		if(_cli.play_audio_after.presented()) {
+			round.say_after = word.kana;
+		}
+
+		round.expected = word.meaning;
+	}
+
+	/**
+	 * Writes the word for the kanji and kana flags, the meaning for the arabic ones.
+	 */
+	static void write_word(const Lexicon::Entry& word, const bool kanji, const bool kana, const bool meaning, std::string& output) {
+		if(kanji) {
+			output.append(word.expression());
+		}
+		if(kana && not (kanji && word.kanji.empty())) {
+			if(not output.empty()) {
+				output.append("  ");
+			}
+			output.append(word.kana);
+		}
+		if(meaning) {
+			if(not output.empty()) {
+				output.append("  ");
+			}
+			output.append(word.meaning);
+		}
+	}
+
+	/**
+	 * Writes @count cards of the mode : the kanji, the reading and the arabic.
+	 */
+	void export_cards(CardWriter& out, const uint64_t count) {
+		String_t text;
+		std::string front;
+		std::string reading;
+		std::string back;
+		ReadingLattice lattice;
+
+		for(uint64_t i = 0; i < count; ++i) {
+			front.clear();
+			reading.clear();
+			back.clear();
+			lattice.clear();
+
+			if(is_quantity(_cli.mode.value())) {
+				const Quantity input = generate_quantity();
+				text.clear();
+				_write_quantity_kanji(input, text);
+				Utf8::append(text, front);
+				NumberRenderer::write_quantity_lattice(input, lattice);
+				NumberRenderer::write_quantity_arabic(input, back);
+			} else if(_cli.mode.value() == NihongoNoSujiCli::EnumMode::MONEY) {
+				const Number input = generate_price();
+				text.clear();
+				write_price_question(input, true, false, false, text);
+				Utf8::append(text, front);
+				NumberRenderer::write_price_lattice(input, lattice);
+				text.clear();
+				NumberRenderer::write_price_arabic(input, text);
+				Utf8::append(text, back);
+			} else if(_cli.mode.value() == NihongoNoSujiCli::EnumMode::TIME) {
 				unsigned hours_24 = 0;
-				unsigned hours_12 = 0;
 				unsigned min = 0;
 				time_generate_input(hours_24, min);
-
-				String_t to_say;
-				if(hours_24 < 12u) {
-					hours_12 = hours_24;
-					to_say.append(U"午前");
+				NumberRenderer::write_time_kanji(hours_24, min, front);
+				NumberRenderer::write_time_lattice(hours_24, min, lattice);
+				NumberRenderer::write_time_arabic(hours_24, min, back);
+			} else {
+				const Number input = generate_input();
+				text.clear();
+				write_question(input, true, false, false, text);
+				Utf8::append(text, front);
+				if(_cli.mode.value() == NihongoNoSujiCli::EnumMode::NUMBERS) {
+					NumberRenderer::write_number_lattice(input, lattice);
 				} else {
-					hours_12 = hours_24 - 12u;
-					to_say.append(U"午後");
+					NumberRenderer::write_digits_lattice(input, lattice);
 				}
-				to_say.append(to_u32_string(std::to_string(hours_12)));
-				to_say.append(U"時");
+				text.clear();
+				NumberRenderer::write_digits(input, NumberRenderer::DIGIT_MAP_ARABIC, text);
+				Utf8::append(text, back);
+			}
 
-				switch(min) {
-					case 0:
-						break;
+			lattice.write_canonical(reading);
+			out.card(front, reading, back);
+		}
+	}
 
-					case 30:
-						to_say.append(U"半");
-						break;
+	void write_question(const Number& buf, const bool kanji, const bool kana, const bool arabic, String_t& question) const {
+		const bool numbers = _cli.mode.value() == NihongoNoSujiCli::EnumMode::NUMBERS;
 
-					default:
-						to_say.append(to_u32_string(std::to_string(min)));
-						to_say.append(U"分");
-						break;
-				}
+		if(kanji) {
+			if(numbers) {
+				_write_number_kanji(buf, question);
+			} else {
+				NumberRenderer::write_digits(buf, NumberRenderer::DIGIT_MAP_KANJI, question);
+			}
+		}
 
-				String_t reference;
-				if(hours_24 < 10) {
-					reference.push_back('0');
-				}
-				reference.append(to_u32_string(std::to_string(hours_24)));
-				reference.push_back(':');
-				if(min < 10) {
-					reference.push_back('0');
-				}
-				reference.append(to_u32_string(std::to_string(min)));
+		if(kana) {
+			if(not question.empty()) {
+				question.append(U"  ");
+			}
+			if(numbers) {
+				NumberRenderer::write_number_hiragana(buf, question);
+			} else {
+				NumberRenderer::write_digits(buf, NumberRenderer::DIGIT_MAP_HIRAGANA, question);
+			}
+		}
 
-				if(_cli.show_arabic_before.presented()) {
-					printf("%s ", to_basic_string(reference).c_str());
-					fflush(stdout);
-				}
+		if(arabic) {
+			if(not question.empty()) {
+				question.append(U"  ");
+			}
+			NumberRenderer::write_digits(buf, NumberRenderer::DIGIT_MAP_ARABIC, question);
+		}
+	}
 
-				if(_cli.show_kanji_before.presented()) {
-					printf("%s ", to_basic_string(to_say).c_str());
-					fflush(stdout);
-				}
+	void write_quantity_question(const Quantity& input, const bool kanji, const bool kana, const bool arabic, String_t& question) const {
+		if(kanji) {
+			_write_quantity_kanji(input, question);
+		}
+		if(kana) {
+			if(not question.empty()) {
+				question.append(U"  ");
+			}
+			NumberRenderer::write_quantity_hiragana(input, question);
+		}
+		if(arabic) {
+			if(not question.empty()) {
+				question.append(U"  ");
+			}
+			NumberRenderer::write_quantity_arabic(input, question);
+		}
+	}
+
+	void write_price_question(const Number& input, const bool kanji, const bool kana, const bool arabic, String_t& question) const {
+		if(kanji) {
+			_write_number_kanji(input, question);
+			question.append(NumberRenderer::YEN);
+		}
+		if(kana) {
+			if(not question.empty()) {
+				question.append(U"  ");
+			}
+			NumberRenderer::write_price_hiragana(input, question);
+		}
+		if(arabic) {
+			if(not question.empty()) {
+				question.append(U"  ");
+			}
+			NumberRenderer::write_price_arabic(input, question);
+		}
+	}
+
+	void write_audio(const Number& buf, String_t& to_say) const {
+		if(_cli.mode.value() == NihongoNoSujiCli::EnumMode::NUMBERS) {
+			NumberRenderer::write_digits(buf, NumberRenderer::DIGIT_MAP_ARABIC, to_say);
+		} else {
+			NumberRenderer::write_digits(buf, NumberRenderer::DIGIT_MAP_ARABIC_SEP, to_say);
+		}
+	}
+
+	void show_before(const Round& round) {
+		NNS_TRACE_SPAN("show_before");
+		show(round.before, round.say_before, round.say_first);
+	}
+
+	void show_after(const Round& round) {
+		NNS_TRACE_SPAN("show_after");
+		show(round.after, round.say_after, false);
+	}
+
+	void show(const std::string& text, const std::string& to_say, const bool say_first) {
+		if(say_first && (not to_say.empty())) {
+			say(to_say);
+		}
+		if(not text.empty()) {
+			_con.print("%s", text.c_str());
+		}
+		_con.flush();
+		if((not say_first) && (not to_say.empty())) {
+			say(to_say);
+		}
+	}
+
+	bool is_correct(const Round& round, const std::string& output) const {
+		if(round.word != nullptr) {
+			return FuzzyMatcher::matches(round.word->meaning, output, _cli.fuzzy);
+		}
+		if(_cli.kana_answer.presented()) {
+			return round.lattice.accepts(output);
+		}
+		if(round.has_number) {
+			return round.number.matches(std::string_view(output));
+		}
+		if(round.has_quantity) {
+			return round.quantity.matches(output);
+		}
+		if(round.has_price) {
+			return round.number.matches_price(output);
+		}
+		return output == round.expected;
+	}
 
-				if(_cli.play_audio_before.presented()) {
-					say(to_say);
+	/**
+	 * Shows the round, then reads and checks the answers.
+	 * @return false if the input is over before the round is completed.
+	 */
+	bool play_round(const Round& round, unsigned& mistakes) {
+		_con.question(round.expected);
+		show_before(round);
+
+		// Read the output, the spaces of a meaning are kept.
+		const bool skip_spaces = round.word == nullptr;
+		std::string output;
+		const auto tm_shown = std::chrono::steady_clock::now();
+		uint64_t response_us = 0;
+		bool late = false;
+		if(_deadline.enabled()) {
+			const uint64_t deadline_us = _deadline.current_us();
+			const Console::Answer answer = read_answer(output, skip_spaces, deadline_us, response_us);
+			if(answer == Console::Answer::OVER) {
+				return false;
+			}
+			late = answer == Console::Answer::TIMEOUT || response_us > deadline_us;
+			if(answer == Console::Answer::TIMEOUT) {
+				_con.print("\n");
+			}
+			_con.print("%s%.3f s of %.3f s%s\n", TermColor::front(late ? TermColor::RED : TermColor::GREEN),
+				double(response_us) / 1e6, double(deadline_us) / 1e6, TermColor::reset());
+		} else if(not read_line(output, skip_spaces)) {
+			return false;
+		}
+		const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tm_shown);
+		Metrics::observe(Metrics::INPUT_LATENCY, uint64_t(latency.count()));
+
+		if(checks_answers()) {
+			const bool correct = (not late) && is_correct(round, output);
+			if(_deadline.enabled()) {
+				_deadline.answer(response_us, late, correct);
+			}
+			// A right answer too late is a mistake as well.
+			if(late && is_correct(round, output)) {
+				++mistakes;
+			}
+			if(_progress != nullptr) {
+				update_progress(round.item, correct, uint32_t(latency.count()));
+			}
+			if(not correct) {
+				Metrics::add(Metrics::MISTAKES);
+			}
+
+			// Check the result.
+			while(not is_correct(round, output)) {
+				++mistakes;
+				Metrics::add(Metrics::RETRIES);
+				_con.print("%s", TermColor::front(TermColor::RED));
+				_con.print("%s", round.expected.c_str());
+				_con.print("\n%s", TermColor::reset());
+
+				show_before(round);
+				if(not read_line(output, skip_spaces)) {
+					return false;
 				}
+			}
+			_con.print("\n");
+		}
 
-				// Read the output.
-				String_t output;
-				read_line(stdin, output, true);
-
-				if(_cli.action.action().value == NihongoNoSujiCli::EnumMethod::TEST) {
-					// Check the result.
-					while (output != reference) {
-						++mistakes;
-						printf("%s", TermColor::front(TermColor::RED));
-						printf("%s", to_basic_string(reference).c_str());
-						printf("\n%s", TermColor::reset());
-
-						if(_cli.show_arabic_before.presented()) {
-							printf("%s ", to_basic_string(reference).c_str());
-							fflush(stdout);
-						}
+		show_after(round);
+		Metrics::add(Metrics::ROUNDS);
+		return true;
+	}
 
-						if(_cli.show_kanji_before.presented()) {
-							printf("%s ", to_basic_string(to_say).c_str());
-							fflush(stdout);
-						}
+	void save_checkpoint() {
+		if(not _checkpoint->save()) {
+			fprintf(stderr, "Can not write the checkpoint : %s\n", _checkpoint->error().c_str());
+		}
+	}
 
-						if(_cli.play_audio_before.presented()) {
-							say(to_say);
-						}
+	/**
+	 * Counts the first answer of a round, the record is durable before the next round.
+	 */
+	void update_progress(const uint64_t item, const bool correct, const uint32_t latency_ms) {
+		ProgressStore::Record record{};
+		if(not _progress->find(item, record)) {
+			record.key = item;
+		}
+		++record.attempts;
+		record.correct += correct ? 1u : 0u;
+		record.streak = correct ? uint16_t(std::min<unsigned>(record.streak + 1u, UINT16_MAX)) : 0u;
+		record.latency_ms = uint32_t(record.latency_ms + (int64_t(latency_ms) - int64_t(record.latency_ms)) / int64_t(record.attempts));
+		record.last_seen = uint64_t(time(nullptr));
+
+		if(not (_progress->put(record) && _progress->commit())) {
+			fprintf(stderr, "Can not update the progress : %s\n", _progress->error().c_str());
+			_progress = nullptr;
+		}
+	}
+
+	void run() {
+		const uint64_t tm_before = _con.clock_ms();
+		const auto tm_session = std::chrono::steady_clock::now();
 
-						fflush(stdout);
-						read_line(stdin, output, true);
+		const unsigned rounds_total = _cli.rounds;
+		unsigned rounds_done = 0;
+		unsigned mistakes = 0;
+		uint64_t elapsed_before = 0;
+		if(_checkpoint != nullptr && _checkpoint->resumed()) {
+			const Checkpoint::State& state = _checkpoint->restored();
+			_dm = DiceMachine(state.rng);
+			rounds_done = std::min<unsigned>(state.rounds_done, rounds_total);
+			mistakes = state.mistakes;
+			elapsed_before = state.elapsed_ms;
+		}
+		const unsigned rounds_resumed = rounds_done;
+
+		// The next rounds are prepared by a producer thread while the user answers.
+		std::unique_ptr<RoundRing_t> ring;
+		std::atomic<bool> stop(false);
+		std::thread producer;
+		if(_cli.pregenerate.presented()) {
+			ring = std::make_unique<RoundRing_t>();
+			producer = std::thread([this, &ring, &stop, rounds_resumed, rounds_total] {
+				for(unsigned i = rounds_resumed; i < rounds_total; ++i) {
+					Round* round;
+					unsigned attempt = 0;
+					while((round = ring->back()) == nullptr) {
+						if(stop.load(std::memory_order_relaxed)) {
+							return;
+						}
+						RoundRing_t::backoff(attempt);
 					}
-					printf("\n");
+					prepare_round(*round);
+					ring->push();
 				}
+			});
+		}
 
-				if(_cli.show_arabic_after.presented()) {
-					printf("%s ", to_basic_string(reference).c_str());
-					fflush(stdout);
+		Round local;
+		bool input_over = false;
+		// The round the input is over in counts if it has been answered.
+		unsigned rounds_answered = 0;
+		while(rounds_done < rounds_total && (not input_over)) {
+			Round* round = &local;
+			if(ring) {
+				unsigned attempt = 0;
+				while((round = ring->front()) == nullptr) {
+					RoundRing_t::backoff(attempt);
 				}
+			} else {
+				prepare_round(local);
+			}
 
-				if(_cli.show_kanji_after.presented()) {
-					printf("%s ", to_basic_string(to_say).c_str());
-					fflush(stdout);
+			if(_checkpoint != nullptr) {
+				const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tm_session);
+				_checkpoint->update(Checkpoint::State{round->rng, rounds_done, mistakes, elapsed_before + uint64_t(elapsed.count())});
+				if(rounds_done > rounds_resumed && (rounds_done - rounds_resumed) % _cli.checkpoint_interval == 0) {
+					save_checkpoint();
 				}
+			}
 
-				if(_cli.play_audio_after.presented()) {
-					say(to_say);
-				}
+			const unsigned mistakes_before = mistakes;
+			input_over = not play_round(*round, mistakes);
+			if(ring) {
+				ring->pop();
+			}
+			if(input_over) {
+				rounds_answered = mistakes > mistakes_before ? 1u : 0u;
+				break;
+			}
+			++rounds_done;
 
-				continue;
+			if(_cli.wait_for_user.presented() && _cli.mode.value() != NihongoNoSujiCli::EnumMode::TIME) {
+				std::string output;
+				_con.flush();
+				_con.print("<ready>");
+				input_over = not read_line(output, true);
 			}
+		}
 
-			const Buffer_t input = generate_input();
-			String_t reference;
-			write_digits(input, DIGIT_MAP_ARABIC, reference);
+		stop.store(true, std::memory_order_relaxed);
+		if(producer.joinable()) {
+			producer.join();
+		}
 
-			show_before(input);
-			fflush(stdout);
+		// The pending round of an interrupted session is asked again.
+		if(_checkpoint != nullptr) {
+			if(rounds_done == rounds_total) {
+				_checkpoint->remove();
+			} else {
+				save_checkpoint();
+			}
+		}
 
-			// Read the output.
-			String_t output;
-			read_line(stdin, output, true);
+		_mistakes = mistakes;
+		rounds_answered += rounds_done;
+		if(rounds_answered > 0) {
+			double miskates_percent = mistakes;
+			miskates_percent /= rounds_answered;
+			miskates_percent *= 100;
+			_con.print("Mistakes : %u of %u (%.2f%%).", mistakes, rounds_answered, miskates_percent);
+		} else {
+			_con.print("Mistakes : %u of %u.", mistakes, rounds_answered);
+		}
+		const unsigned seconds_total = unsigned((_con.clock_ms() - tm_before + elapsed_before) / 1000u);
+		_con.print(" %u seconds.\n", seconds_total);
+		if(_deadline.enabled() && _deadline.count() > 0) {
+			_con.print("Responses : mean %.3f s, median %.3f s, 90%% in %.3f s, %u late.\n", double(_deadline.mean_us()) / 1e6,
+				double(_deadline.percentile_us(50u)) / 1e6, double(_deadline.percentile_us(90u)) / 1e6, _deadline.late());
+		}
+		_con.flush();
+	}
 
-			if(_cli.action.action().value == NihongoNoSujiCli::EnumMethod::TEST) {
-				// Check the result.
-				while (output != reference) {
-					++mistakes;
-					printf("%s", TermColor::front(TermColor::RED));
-					printf("%s", to_basic_string(reference).c_str());
-					printf("\n%s", TermColor::reset());
+	bool read_line(std::string& buf, const bool skip_spaces) {
+		NNS_TRACE_SPAN("read_line");
+		const bool result_read = _con.read_line(buf);
+		normalize_answer(buf, skip_spaces);
+		return result_read;
+	}
 
-					show_before(input);
-					fflush(stdout);
-					read_line(stdin, output, true);
-				}
-				printf("\n");
-			}
+	/**
+	 * The timed read_line() of the speed drill.
+	 */
+	Console::Answer read_answer(std::string& buf, const bool skip_spaces, const uint64_t timeout_us, uint64_t& response_us) {
+		NNS_TRACE_SPAN("read_answer");
+		const Console::Answer result = _con.read_answer(buf, timeout_us, response_us);
+		normalize_answer(buf, skip_spaces);
+		return result;
+	}
 
-			show_after(input);
+	void normalize_answer(std::string& buf, const bool skip_spaces) {
+		if(skip_spaces) {
+			buf.erase(std::remove_if(buf.begin(), buf.end(), [](const char ch) { return isspace(ch); }), buf.end());
+		}
+		if(_cli.kana_answer.presented()) {
+			NNS_TRACE_SPAN("romaji");
+			std::string kana;
+			Romaji::to_hiragana(buf, kana);
+			buf.swap(kana);
+		}
+	}
 
-			if(_cli.wait_for_user.presented()) {
-				fflush(stdout);
-				printf("<ready>");
-				read_line(stdin, output, true);
-			}
 
+	void say(const std::string& to_say) {
+		NNS_TRACE_SPAN("say");
+		Metrics::add(Metrics::SAY);
+		if(not _con.say(to_say)) {
+			Metrics::add(Metrics::SAY_FAILURES);
 		}
+	}
 
-		double miskates_percent = mistakes;
-		miskates_percent /= rounds_total;
-		miskates_percent *= 100;
+	static std::string to_basic_string(const std::u32string& str) {
+		NNS_TRACE_SPAN("utf8");
+		std::string result;
+		Utf8::append(str, result);
+		return result;
+	}
 
-		printf("Mistakes : %u of %u (%.2f%%).", mistakes, rounds_total, miskates_percent);
-		const unsigned seconds_total = time(nullptr) - tm_before;
-		printf(" %u seconds.\n", seconds_total);
+};
 
+/**
+ * Loads the dictionaries and selects the words by the filter in the words mode.
+ * The words of @progress answered right MASTERED_STREAK times in a row are mastered.
+ */
+bool load_words(const NihongoNoSujiCli& cli, Lexicon& lex, Lexicon::Selection& words, const ProgressStore* progress = nullptr) {
+	if(cli.mode.value() != NihongoNoSujiCli::EnumMode::WORDS) {
+		return true;
 	}
 
-	// private:
+	if(not lex.load(cli.dictionary_file.value())) {
+		fprintf(stderr, "Can not load '%s'\n", lex.error().c_str());
+		return false;
+	}
 
-	void generate_test_input(Buffer_t& buf) {
-		static unsigned text_idx = 0;
-		switch(text_idx % 9u) {
-			case 0:
-				buf = {1};
-				break;
+	if(progress != nullptr) {
+		ProgressStore::Record record;
+		for(size_t idx = 0; idx < lex.size(); ++idx) {
+			if(progress->find(NihongoNoSuji::word_key(lex[idx]), record) && record.streak >= NihongoNoSuji::MASTERED_STREAK) {
+				lex.set(idx, Lexicon::MASTERED);
+			}
+		}
+	}
 
-			case 1:
-				buf = {1,1};
-				// buf = {1, 0};
-				break;
+	Lexicon::Filter filter;
+	filter.parse(cli.words_filter.value());
+	lex.select(filter, words);
+	if(words.count() == 0) {
+		fprintf(stderr, "No words are selected.\n");
+		return false;
+	}
+	return true;
+}
 
-			case 2:
-				buf = {1,1,1};
-				// buf = {1, 0, 0};
-				break;
+/**
+ * Runs from 1 up to N virtual learners in parallel, one thread each, and reports the scaling.
+ */
+int simulate(const NihongoNoSujiCli& cli, const uint64_t seed) {
+	Lexicon lex;
+	Lexicon::Selection words;
+	if(not load_words(cli, lex, words)) {
+		return EXIT_FAILURE;
+	}
 
-			case 3:
-				buf = {1,1,1,1};
-				// buf = {1, 0, 0, 0};
-				break;
+	unsigned threads_max = cli.threads;
+	if(threads_max == 0) {
+		threads_max = std::max(1u, std::thread::hardware_concurrency());
+	}
 
-			case 4:
-				buf = {1,1,1,1,1};
-				// buf = {1, 0, 0, 0, 0};
-				break;
+	printf("%8s %12s %12s %14s %10s\n", "learners", "rounds", "answers", "rounds/s", "scaling");
+
+	double rps_single = 0;
+	unsigned learners = 1;
+	while(true) {
+		std::vector<uint64_t> rounds(learners);
+		std::vector<uint64_t> answers(learners);
+		std::vector<std::thread> workers;
+		workers.reserve(learners);
+
+		const auto tm_before = std::chrono::steady_clock::now();
+		for(unsigned i = 0; i < learners; ++i) {
+			workers.emplace_back([&cli, &lex, &words, &rounds, &answers, seed, i] {
+				LearnerConsole con(cli.script_error, cli.latency, ~(seed + i));
+				NihongoNoSuji app(cli, con, seed + i);
+				app.set_words(lex, words);
+				app.run();
+				rounds[i] = con.rounds();
+				answers[i] = con.answers();
+			});
+		}
+		for(auto& worker : workers) {
+			worker.join();
+		}
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - tm_before;
 
-			case 5:
-				buf = {1,1,1,1,1,1};
-				// buf = {1, 0, 0, 0, 0, 0};
-				break;
+		uint64_t rounds_total = 0;
+		uint64_t answers_total = 0;
+		for(unsigned i = 0; i < learners; ++i) {
+			rounds_total += rounds[i];
+			answers_total += answers[i];
+		}
 
-			case 6:
-				buf = {1,1,1,1,1,1,1};
-				// buf = {1, 0, 0, 0, 0, 0, 0};
-				break;
+		const double rps = rounds_total / elapsed.count();
+		if(learners == 1) {
+			rps_single = rps;
+		}
+		printf("%8u %12" PRIu64 " %12" PRIu64 " %14.0f %9.1f%%\n", learners, rounds_total, answers_total, rps, 100 * rps / (learners * rps_single));
 
-			case 7:
-				buf = {1,1,1,1,1,1,1,1};
-				// buf = {1, 0, 0, 0, 0, 0, 0, 0};
-				break;
+		if(learners == threads_max) {
+			break;
+		}
+		learners = std::min(learners * 2u, threads_max);
+	}
 
-			case 8:
-				buf = {1,1,1,1,1,1,1,1,1};
-				// buf = {1, 0, 0, 0, 0, 0, 0, 0, 0};
-				break;
+	return EXIT_SUCCESS;
+}
 
-		}
-		++text_idx;
+int bench_romaji(const NihongoNoSujiCli& cli, const uint64_t seed) {
+	static constexpr const char* WORDS[] = {
+		"rei", "zero", "ichi", "ni", "san", "yon", "shi", "go", "roku", "nana", "shichi", "hachi", "kyuu", "ku",
+		"juu", "hyaku", "sanbyaku", "roppyaku", "happyaku", "sen", "sanzen", "hassen", "man", "oku", "nn", "n'"
+	};
+	static constexpr size_t WORDS_SIZE = sizeof(WORDS) / sizeof(WORDS[0]);
+	static constexpr size_t BATCH_SIZE = 1u << 20u;
+
+	DiceMachine dm(seed);
+	std::string input;
+	while(input.size() < BATCH_SIZE) {
+		input.append(WORDS[std::abs(dm.lrand48()) % WORDS_SIZE]);
 	}
 
-	bool read_line(FILE* input, String_t& result, const bool skip_spaces) {
-		std::string buf;
-		int ch;
-		while((ch = getc(input)) != EOF) {
-			if(ch == '\n') {
-				break;
-			}
-			if(skip_spaces && isspace(ch)) {
-				continue;
-			}
-			buf.push_back(ch);
+	std::string output;
+	output.reserve(input.size() * 3u);
+	const auto tm_batch = std::chrono::steady_clock::now();
+	for(unsigned i = 0; i < cli.rounds; ++i) {
+		output.clear();
+		Romaji::to_hiragana(input, output);
+	}
+	const std::chrono::duration<double> elapsed_batch = std::chrono::steady_clock::now() - tm_batch;
+
+	std::string word;
+	word.reserve(64);
+	const auto tm_word = std::chrono::steady_clock::now();
+	for(unsigned i = 0; i < cli.rounds; ++i) {
+		for(const char* item : WORDS) {
+			word.clear();
+			Romaji::to_hiragana(item, word);
 		}
-		result = to_u32_string(buf);
-		return ch != EOF;
 	}
+	const std::chrono::duration<double> elapsed_word = std::chrono::steady_clock::now() - tm_word;
 
+	const double mb = double(input.size()) * cli.rounds / (1u << 20u);
+	printf("Romaji : %.1f MB in %.6f seconds (%.1f MB/s), %.0f ns per word.\n",
+		mb, elapsed_batch.count(), mb / elapsed_batch.count(), elapsed_word.count() * 1e9 / (double(cli.rounds) * WORDS_SIZE));
+	return EXIT_SUCCESS;
+}
 
-	template <typename M>
-	static void write_digits(const Buffer_t& input, const M& map, String_t& output) {
-		for(const auto& item : input) {
-			output.append(map[item]);
-		}
+/**
+ * Filters a synthetic lexicon of 200k words with random levels, parts of speech and decks.
+ */
+int bench_filter(const NihongoNoSujiCli& cli, const uint64_t seed) {
+	static constexpr size_t WORDS = 200000u;
+	static constexpr Lexicon::Tags_t PARTS[] = {Lexicon::NOUN, Lexicon::VERB, Lexicon::ADJ_I, Lexicon::ADJ_NA, Lexicon::ADVERB};
+
+	DiceMachine dm(seed);
+	std::vector<std::string> keys(WORDS);
+	Lexicon lex;
+	for(size_t i = 0; i < WORDS; ++i) {
+		keys[i] = std::to_string(i);
+		Lexicon::Tags_t tags = Lexicon::LEVEL_N5 << dm.below(5);
+		tags |= PARTS[dm.below(5)];
+		tags |= dm.pass(0.3) ? Lexicon::COMMON : 0;
+		tags |= Lexicon::DECK_0 << dm.below(Lexicon::DECKS);
+		tags |= dm.pass(0.5) ? Lexicon::MASTERED : 0;
+		lex.add(Dictionary::Entry{std::string_view(), keys[i], keys[i], std::string_view()}, tags);
 	}
 
-	static void write_number_kanji(const Buffer_t& buf, String_t& output) {
-		bool has_man = false;
+	Lexicon::Filter filter;
+	filter.parse(cli.words_filter.presented() ? cli.words_filter.value() : "n4,verb,-mastered");
 
-		for(size_t idx = 0; idx < buf.size(); ++idx) {
-			const size_t exp = buf.size() - idx - 1u;
-			// printf("exp=%zu buf[idx]=%u\n", exp, buf[idx]);
+	Lexicon::Selection selection;
+	const auto tm_before = std::chrono::steady_clock::now();
+	for(unsigned i = 0; i < cli.rounds; ++i) {
+		lex.select(filter, selection);
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - tm_before;
 
-			switch(exp) {
-				case 0u:
-					if(buf[idx] > 0) {
-						output.append(DIGIT_MAP_KANJI[buf[idx]]);
-					}
-					break;
+	printf("Filter : %zu of %zu words selected, %.1f us per scan.\n",
+		selection.count(), lex.size(), elapsed.count() * 1e6 / cli.rounds);
+	return EXIT_SUCCESS;
+}
 
-				case 1u:
-					if(buf[idx] > 1) {
-						output.append(DIGIT_MAP_KANJI[buf[idx]]);
-					}
-					if(buf[idx] > 0) {
-						output.append(U"十");
-					}
-					break;
+/**
+ * Queries an index of 300k synthetic meanings made of a Zipf-like vocabulary.
+ */
+int bench_index(const NihongoNoSujiCli& cli, const uint64_t seed) {
+	static constexpr size_t WORDS = 300000u;
+	static constexpr size_t VOCABULARY = 20000u;
+	static constexpr size_t QUERIES = 1024u;
+
+	DiceMachine dm(seed);
+	auto term = [&dm]() {
+		// Low ranks are much more frequent.
+		const uint64_t rank = dm.below(dm.below(VOCABULARY) + 1u);
+		return "w" + std::to_string(rank);
+	};
+
+	std::vector<std::string> meanings(WORDS);
+	std::vector<std::string> keys(WORDS);
+	Lexicon lex;
+	for(size_t i = 0; i < WORDS; ++i) {
+		const uint64_t size = 1u + dm.below(6);
+		for(uint64_t j = 0; j < size; ++j) {
+			meanings[i].append(j > 0 ? ", " : "").append(term());
+		}
+		keys[i] = std::to_string(i);
+		lex.add(Dictionary::Entry{std::string_view(), keys[i], meanings[i], std::string_view()}, 0);
+	}
 
-				case 2u:
-					if(buf[idx] > 1) {
-						output.append(DIGIT_MAP_KANJI[buf[idx]]);
-					}
-					if(buf[idx] > 0) {
-						output.append(U"百");
-					}
-					break;
+	const auto tm_build = std::chrono::steady_clock::now();
+	GlossIndex index;
+	index.build(lex);
+	const std::chrono::duration<double> elapsed_build = std::chrono::steady_clock::now() - tm_build;
 
-				case 3u:
-					if(buf[idx] > 1) {
-						output.append(DIGIT_MAP_KANJI[buf[idx]]);
-					}
-					if(buf[idx] > 0) {
-						output.append(U"千");
-					}
-					break;
+	std::vector<std::string> queries(QUERIES);
+	for(auto& query : queries) {
+		query = term();
+		if(dm.pass(0.5)) {
+			query.append(" ").append(term());
+		}
+	}
 
-				case 4u:
-					if(buf[idx] > 0) {
-						output.append(DIGIT_MAP_KANJI[buf[idx]]);
-					}
-					if(buf[idx] > 0 || has_man) {
-						output.append(U"万");
-					}
-					break;
+	std::vector<uint32_t> result;
+	uint64_t found = 0;
+	const auto tm_before = std::chrono::steady_clock::now();
+	for(unsigned i = 0; i < cli.rounds; ++i) {
+		for(const auto& query : queries) {
+			result.clear();
+			found += index.find(query, result, 16u);
+		}
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - tm_before;
 
-				case 5u:
-					if(buf[idx] > 1) {
-						output.append(DIGIT_MAP_KANJI[buf[idx]]);
-					}
-					if(buf[idx] > 0) {
-						has_man = true;
-						output.append(U"十");
-					}
-					break;
+	printf("Index : %zu terms, %zu bytes, built in %.3f seconds, %" PRIu64 " found, %.2f us per query.\n",
+		index.terms(), index.bytes(), elapsed_build.count(), found, elapsed.count() * 1e6 / (double(cli.rounds) * QUERIES));
+	return EXIT_SUCCESS;
+}
 
-				case 6u:
-					if(buf[idx] > 1) {
-						output.append(DIGIT_MAP_KANJI[buf[idx]]);
-					}
-					if(buf[idx] > 0) {
-						has_man = true;
-						output.append(U"百");
-					}
-					break;
+/**
+ * Measures the cost of a counter update and of a histogram observation on the hot path.
+ */
+int bench_metrics(const NihongoNoSujiCli& cli, const uint64_t seed) {
+	static constexpr size_t BATCH_SIZE = 1u << 20u;
 
-				case 7u:
-					if(buf[idx] > 1) {
-						output.append(DIGIT_MAP_KANJI[buf[idx]]);
-					}
-					if(buf[idx] > 0) {
-						has_man = true;
-						output.append(U"千");
-					}
-					break;
+	DiceMachine dm(seed);
+	std::vector<uint64_t> values(BATCH_SIZE);
+	for(uint64_t& value : values) {
+		value = dm.below(1u << 24u);
+	}
 
-				case 8u:
-					if(buf[idx] > 0) {
-						output.append(DIGIT_MAP_KANJI[buf[idx]]);
-					}
-					if(buf[idx] > 0) {
-						output.append(U"億");
-					}
-					break;
+	const auto tm_add = std::chrono::steady_clock::now();
+	for(unsigned i = 0; i < cli.rounds; ++i) {
+		for(size_t j = 0; j < BATCH_SIZE; ++j) {
+			Metrics::add(Metrics::ROUNDS);
+		}
+	}
+	const std::chrono::duration<double> elapsed_add = std::chrono::steady_clock::now() - tm_add;
 
-				default:
-					break;
-			}
+	const auto tm_observe = std::chrono::steady_clock::now();
+	for(unsigned i = 0; i < cli.rounds; ++i) {
+		for(const uint64_t value : values) {
+			Metrics::observe(Metrics::RENDER_TIME, value);
 		}
+	}
+	const std::chrono::duration<double> elapsed_observe = std::chrono::steady_clock::now() - tm_observe;
+
+	std::string text;
+	Metrics::write(text);
 
-		if(output.empty()) {
-			output = U"ゼロ";
+	const double updates = double(cli.rounds) * BATCH_SIZE;
+	printf("Metrics : %.2f ns per counter update, %.2f ns per histogram observation, %zu bytes of text.\n",
+		elapsed_add.count() * 1e9 / updates, elapsed_observe.count() * 1e9 / updates, text.size());
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Measures the distractors of the multiple choice for numbers of 1 ... 9 digits.
+ */
+int bench_distractors(const NihongoNoSujiCli& cli, const uint64_t seed) {
+	static constexpr size_t QUESTIONS = 1u << 16u;
+	static constexpr unsigned COUNT = 5u;
+
+	DiceMachine dm(seed);
+	std::vector<Number> questions(QUESTIONS);
+	for(Number& question : questions) {
+		question = Questions::number(dm, 1u, 9u);
+	}
+
+	Distractors distractors;
+	std::array<Number, COUNT> output;
+	uint64_t close = 0;
+	const auto tm_before = std::chrono::steady_clock::now();
+	for(unsigned i = 0; i < cli.rounds; ++i) {
+		for(const Number& question : questions) {
+			distractors.generate(dm, question, NihongoNoSujiCli::NUMBERS_MAX_WIDTH, output.data(), COUNT);
+			close += output[0].width == question.width ? 1u : 0u;
 		}
 	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - tm_before;
 
-	static void write_number_hiragana(const Buffer_t& buf, String_t& output) {
-		bool has_man = false;
+	const double generated = double(cli.rounds) * QUESTIONS;
+	printf("Distractors : %u per question, %.1f%% of the first ones of the same width, %.3f us per question.\n",
+		COUNT, 100 * close / generated, elapsed.count() * 1e6 / generated);
+	return EXIT_SUCCESS;
+}
 
-		for(size_t idx = 0; idx < buf.size(); ++idx) {
-			const size_t exp = buf.size() - idx - 1u;
-			// printf("exp=%zu buf[idx]=%u\n", exp, buf[idx]);
+/**
+ * Measures how late the timed read of the speed drill wakes up after its deadline on a silent pipe.
+ */
+int bench_deadline(const NihongoNoSujiCli& cli, const uint64_t) {
+	static constexpr uint64_t TIMEOUT_US = 2000u;
 
-			switch(exp) {
-				case 0u:
-					if(buf[idx] > 0) {
-						output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
-					}
-					break;
+	int fds[2];
+	if(pipe(fds) != 0) {
+		fprintf(stderr, "Can not create a pipe.\n");
+		return EXIT_FAILURE;
+	}
+	FILE* in = fdopen(fds[0], "r");
+	StdConsole con(in, stdout);
+	StdConsole::tighten_timer_slack();
+
+	std::string line;
+	std::vector<uint64_t> late_us(cli.rounds);
+	unsigned timeouts = 0;
+	for(uint64_t& late : late_us) {
+		uint64_t response_us = 0;
+		const auto tm_before = std::chrono::steady_clock::now();
+		timeouts += con.read_answer(line, TIMEOUT_US, response_us) == Console::Answer::TIMEOUT ? 1u : 0u;
+		const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tm_before);
+		late = uint64_t(elapsed.count()) > TIMEOUT_US ? uint64_t(elapsed.count()) - TIMEOUT_US : 0;
+	}
+	fclose(in);
+	close(fds[1]);
 
-				case 1u:
-					if(buf[idx] > 1) {
-						output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
-					}
-					if(buf[idx] > 0) {
-						output.append(U"じゅう");
-					}
-					break;
-
-				case 2u:
-					switch(buf[idx]) {
-						case 1u:
-							output.append(U"ひゃく");
-							break;
-
-						case 2u:
-						case 4u:
-						case 5u:
-						case 7u:
-						case 9u:
-							output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
-							output.append(U"ひゃく");
-							break;
-
-						case 3u:
-							output.append(U"さんびゃく");
-							break;
-
-						case 6u:
-							output.append(U"ろっぴゃく");
-							break;
-
-						case 8u:
-							output.append(U"はっぴゃく");
-							break;
+	std::sort(late_us.begin(), late_us.end());
+	printf("Deadline : %u timeouts of %u, late by %" PRIu64 " us in the median, %" PRIu64 " us in 99%%, %" PRIu64 " us at most.\n",
+		timeouts, cli.rounds.value(), late_us[late_us.size() / 2u], late_us[late_us.size() * 99u / 100u], late_us.back());
+	return EXIT_SUCCESS;
+}
 
-					}
-					break;
-
-				case 3u:
-					switch(buf[idx]) {
-						case 1u:
-							output.append(U"せん");
-							break;
-
-						case 2u:
-						case 4u:
-						case 5u:
-						case 6u:
-						case 7u:
-						case 9u:
-							output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
-							output.append(U"せん");
-							break;
-
-						case 3u:
-							output.append(U"さんぜん");
-							break;
-
-						case 8u:
-							output.append(U"はっせん");
-							break;
+/**
+ * Checks the error model of the random script in every mode : each answer is wrong with the probability
+ * given, a wrong one is asked again, so the mistakes are ERROR of the answers and ERROR / (1 - ERROR) of the rounds.
+ */
+int bench_script(const NihongoNoSujiCli& cli, const uint64_t seed) {
+	static constexpr double ERROR = 0.5;
+	static constexpr size_t WORDS = 1000u;
+	static constexpr const char* DRILLS[] = {
+		"-M digits -f 1 -t 9 -a",
+		"-M numbers -f 1 -t 9 -a",
+		"-M numbers -f 1 -t 9 -a -H",
+		"-M numbers -f 1 -t 9 -a -j -C 4",
+		"-M time -f 1 -t 1 -a",
+		"-M words -f 1 -t 1 -j -d synthetic",
+		"-M decimals -f 1 -t 6 -a",
+		"-M negatives -f 1 -t 6 -a",
+		"-M fractions -f 1 -t 3 -a",
+		"-M money -f 1 -t 9 -a",
+		"-M money -f 1 -t 9 -a -k -C 4"
+	};
+
+	// Short meanings get the fewest typos.
+	DiceMachine dm(seed);
+	std::vector<std::string> keys(WORDS);
+	std::vector<std::string> meanings(WORDS);
+	Lexicon lex;
+	for(size_t i = 0; i < WORDS; ++i) {
+		keys[i] = std::to_string(i);
+		meanings[i].assign(1u + dm.below(12), char('a' + dm.below(26)));
+		lex.add(Dictionary::Entry{std::string_view(), keys[i], meanings[i], std::string_view()}, 0);
+	}
+	Lexicon::Selection words;
+	lex.select(Lexicon::Filter(), words);
+
+	char options[32];
+	snprintf(options, sizeof(options), "-m test -r %u -e %g ", cli.rounds.value(), ERROR);
+
+	bool result = true;
+	for(const char* drill : DRILLS) {
+		NihongoNoSujiCli drill_cli;
+		const std::string args = std::string(options).append(drill);
+		if(not (drill_cli.action.parse_options(args) && drill_cli.action.validate_args() && drill_cli.validate())) {
+			fprintf(stderr, "Can not parse '%s'\n", args.c_str());
+			return EXIT_FAILURE;
+		}
 
-					}
-					break;
+		ScriptConsole script(ScriptConsole::Policy::RANDOM, ERROR, nullptr, seed + 1u);
+		NihongoNoSuji app(drill_cli, script, seed);
+		app.set_words(lex, words);
+		app.run();
+
+		// Five standard deviations of the binomial count.
+		const double answers = double(script.answers());
+		const double expected = ERROR * answers;
+		const bool right = std::abs(app.mistakes() - expected) <= 5 * std::sqrt(answers * ERROR * (1 - ERROR));
+		result = result && right;
+		printf("%-34s %8" PRIu64 " rounds %8" PRIu64 " answers %8u mistakes, %.0f expected%s\n",
+			drill, script.rounds(), script.answers(), app.mistakes(), expected, right ? "" : " : WRONG");
+	}
+	return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-				case 4u:
-					if(buf[idx] > 0) {
-						output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
-					}
-					if(buf[idx] > 0 || has_man) {
-						output.append(U"まん");
-					}
-					break;
+int bench(const NihongoNoSujiCli& cli, const uint64_t seed) {
+	switch(cli.bench.value().get()) {
+		case NihongoNoSujiCli::EnumBench::ROMAJI:
+			return bench_romaji(cli, seed);
 
-				case 5u:
-					if(buf[idx] > 1) {
-						output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
-					}
-					if(buf[idx] > 0) {
-						has_man = true;
-						output.append(U"じゅう");
-					}
-					break;
+		case NihongoNoSujiCli::EnumBench::FILTER:
+			return bench_filter(cli, seed);
 
-				case 6u:
-					if(buf[idx] > 0) {
-						has_man = true;
-					}
+		case NihongoNoSujiCli::EnumBench::INDEX:
+			return bench_index(cli, seed);
 
-					switch(buf[idx]) {
-						case 1u:
-							output.append(U"ひゃく");
-							break;
-
-						case 2u:
-						case 4u:
-						case 5u:
-						case 7u:
-						case 9u:
-							output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
-							output.append(U"ひゃく");
-							break;
-
-						case 3u:
-							output.append(U"さんびゃく");
-							break;
-
-						case 6u:
-							output.append(U"ろっぴゃく");
-							break;
-
-						case 8u:
-							output.append(U"はっぴゃく");
-							break;
-					}
-					break;
+		case NihongoNoSujiCli::EnumBench::METRICS:
+			return bench_metrics(cli, seed);
 
-				case 7u:
-					if(buf[idx] > 0) {
-						has_man = true;
-					}
+		case NihongoNoSujiCli::EnumBench::DISTRACTORS:
+			return bench_distractors(cli, seed);
 
-					switch(buf[idx]) {
-						case 1u:
-							output.append(U"せん");
-							break;
-
-						case 2u:
-						case 4u:
-						case 5u:
-						case 6u:
-						case 7u:
-						case 9u:
-							output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
-							output.append(U"せん");
-							break;
-
-						case 3u:
-							output.append(U"さんぜん");
-							break;
-
-						case 8u:
-							output.append(U"はっせん");
-							break;
-					}
+		case NihongoNoSujiCli::EnumBench::DEADLINE:
+			return bench_deadline(cli, seed);
 
-					break;
+		case NihongoNoSujiCli::EnumBench::SCRIPT:
+			return bench_script(cli, seed);
 
-				case 8u:
-					if(buf[idx] > 0) {
-						output.append(DIGIT_MAP_HIRAGANA[buf[idx]]);
-					}
-					if(buf[idx] > 0) {
-						output.append(U"おく");
-					}
-					break;
+		default:
+			return EXIT_FAILURE;
+	}
+}
 
-				default:
-					break;
-			}
-		}
+/**
+ * Writes one shard of the export.
+ * The generated cards are split evenly, each shard has its own seed.
+ * The selected words are split into contiguous ranges.
+ */
+bool export_shard(const NihongoNoSujiCli& cli, Console& con, const Lexicon& lex, const Lexicon::Selection& words, const uint64_t seed, const unsigned shard, uint64_t& cards, uint64_t& bytes) {
+	std::string path = cli.output_file.value();
+	if(cli.shards > 1u) {
+		path.append(".").append(std::to_string(shard));
+	}
+
+	FILE* file = fopen(path.c_str(), "wb");
+	if(file == nullptr) {
+		fprintf(stderr, "Can not open '%s'\n", path.c_str());
+		return false;
+	}
 
-		if(output.empty()) {
-			output = U"ゼロ";
+	bool result;
+	{
+		CardWriter out(file, static_cast<CardWriter::Format>(cli.format.value().get()));
+		if(cli.mode.value() == NihongoNoSujiCli::EnumMode::WORDS) {
+			out.header({"Expression", "Reading", "Meaning"});
+			const size_t from = words.count() * shard / cli.shards;
+			const size_t to = words.count() * (shard + 1u) / cli.shards;
+			size_t ordinal = 0;
+			words.for_each([&](const size_t idx) {
+				if(ordinal >= from && ordinal < to) {
+					out.card(lex[idx].expression(), lex[idx].kana, lex[idx].meaning);
+				}
+				++ordinal;
+			});
+		} else {
+			out.header({"Front", "Reading", "Back"});
+			const uint64_t count = cli.rounds / cli.shards + (shard < cli.rounds % cli.shards ? 1u : 0u);
+			NihongoNoSuji app(cli, con, seed + shard);
+			app.export_cards(out, count);
 		}
+		result = out.flush();
+		cards = out.cards();
+		bytes = out.bytes();
+	}
+
+	result = (fclose(file) == 0) && result;
+	if(not result) {
+		fprintf(stderr, "Can not write '%s'\n", path.c_str());
 	}
+	return result;
+}
 
-	void say(const String_t& to_say) const {
-		std::string command("trans -b -p  :en :jpn \"");
-		command.append(to_basic_string(to_say));
-		command.append("\" >> /dev/null");
+int export_deck(const NihongoNoSujiCli& cli, Console& con, const uint64_t seed) {
+	Lexicon lex;
+	Lexicon::Selection words;
+	if(not load_words(cli, lex, words)) {
+		return EXIT_FAILURE;
+	}
 
-		const auto err = system(command.c_str());
-		if(err != EXIT_SUCCESS) {
-			fprintf(stderr, "system(\"%s\") fails\n", command.c_str());
-			exit(err);
+	const unsigned shards = cli.shards;
+	std::vector<uint64_t> cards(shards);
+	std::vector<uint64_t> bytes(shards);
+	std::unique_ptr<bool[]> results(new bool[shards]);
+
+	const auto tm_before = std::chrono::steady_clock::now();
+	if(shards == 1u) {
+		results[0] = export_shard(cli, con, lex, words, seed, 0, cards[0], bytes[0]);
+	} else {
+		std::vector<std::thread> workers;
+		workers.reserve(shards);
+		for(unsigned i = 0; i < shards; ++i) {
+			workers.emplace_back([&, i] {
+				results[i] = export_shard(cli, con, lex, words, seed, i, cards[i], bytes[i]);
+			});
 		}
+		for(auto& worker : workers) {
+			worker.join();
+		}
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - tm_before;
+
+	uint64_t cards_total = 0;
+	uint64_t bytes_total = 0;
+	bool result = true;
+	for(unsigned i = 0; i < shards; ++i) {
+		cards_total += cards[i];
+		bytes_total += bytes[i];
+		result = result && results[i];
 	}
 
-	static std::string to_basic_string(const std::u32string& str) {
-		std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv;
-		return conv.to_bytes(str);
+	printf("Export : %" PRIu64 " cards, %" PRIu64 " bytes in %u files in %.6f seconds (%.0f cards/s).\n",
+		cards_total, bytes_total, shards, elapsed.count(), cards_total / elapsed.count());
+	return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int import_jmdict(const NihongoNoSujiCli& cli) {
+	FILE* out = fopen(cli.output_file.value().c_str(), "wb");
+	if(out == nullptr) {
+		fprintf(stderr, "Can not open '%s'\n", cli.output_file.value().c_str());
+		return EXIT_FAILURE;
 	}
 
-	static std::u32string to_u32_string(const std::string& str) {
-		std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv;
-		return conv.from_bytes(str);
+	JmdictImporter importer(cli.language);
+	const auto tm_before = std::chrono::steady_clock::now();
+	bool result = importer.import(cli.jmdict_file.value().c_str(), out);
+	result = (fclose(out) == 0) && result;
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - tm_before;
+
+	if(not result) {
+		fprintf(stderr, "Can not import '%s' : %s\n", cli.jmdict_file.value().c_str(), importer.error().c_str());
+		return EXIT_FAILURE;
 	}
 
-};
+	const double mb = double(importer.bytes()) / (1u << 20u);
+	printf("Import : %" PRIu64 " of %" PRIu64 " entries, %.1f MB in %.6f seconds (%.1f MB/s).\n",
+		importer.written(), importer.entries(), mb, elapsed.count(), mb / elapsed.count());
+	return EXIT_SUCCESS;
+}
+
+int lookup(const NihongoNoSujiCli& cli) {
+	Lexicon lex;
+	if(not lex.load(cli.dictionary_file.value())) {
+		fprintf(stderr, "Can not load '%s'\n", lex.error().c_str());
+		return EXIT_FAILURE;
+	}
+
+	GlossIndex index;
+	index.build(lex);
+
+	std::vector<uint32_t> result;
+	const auto tm_before = std::chrono::steady_clock::now();
+	const size_t found = index.find(cli.query.value(), result, SIZE_MAX);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - tm_before;
+
+	for(const uint32_t idx : result) {
+		const Lexicon::Entry& word = lex[idx];
+		printf("%.*s\t%.*s\t%.*s\n", int(word.expression().size()), word.expression().data(),
+			int(word.kana.size()), word.kana.data(), int(word.meaning.size()), word.meaning.data());
+	}
+	printf("Lookup : %zu of %zu words in %.1f us.\n", found, lex.size(), elapsed.count() * 1e6);
+	return found > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
 int main(int argc, char** argv) {
 	NihongoNoSujiCli cli;
@@ -738,8 +1580,143 @@ int main(int argc, char** argv) {
 		return EXIT_FAILURE;
 	}
 
-	NihongoNoSuji app(cli);
-	app.run();
+	StdConsole con(stdin, stdout);
+	if(cli.deadline.presented()) {
+		StdConsole::tighten_timer_slack();
+	}
+	const uint64_t seed = cli.seed.presented() ? cli.seed.value() : uint64_t(time(nullptr));
+
+	MetricsExporter metrics;
+	if(cli.metrics.presented() && not metrics.start(cli.metrics.value(), cli.metrics_interval)) {
+		fprintf(stderr, "Can not export the metrics to '%s' : %s\n", cli.metrics.value().c_str(), metrics.error().c_str());
+		return EXIT_FAILURE;
+	}
+
+	if(cli.action.action() == NihongoNoSujiCli::EnumMethod::SIMULATE) {
+		return simulate(cli, seed);
+	}
+
+	if(cli.action.action() == NihongoNoSujiCli::EnumMethod::BENCH) {
+		return bench(cli, seed);
+	}
+
+	if(cli.action.action() == NihongoNoSujiCli::EnumMethod::EXPORT) {
+		return export_deck(cli, con, seed);
+	}
+
+	if(cli.action.action() == NihongoNoSujiCli::EnumMethod::IMPORT) {
+		return import_jmdict(cli);
+	}
+
+	if(cli.action.action() == NihongoNoSujiCli::EnumMethod::LOOKUP) {
+		return lookup(cli);
+	}
+
+	ProgressStore progress;
+	if(cli.progress_file.presented() && not progress.open(cli.progress_file.value().c_str())) {
+		fprintf(stderr, "Can not open '%s' : %s\n", cli.progress_file.value().c_str(), progress.error().c_str());
+		return EXIT_FAILURE;
+	}
+
+	Lexicon lex;
+	Lexicon::Selection words;
+	if(not load_words(cli, lex, words, cli.progress_file.presented() ? &progress : nullptr)) {
+		return EXIT_FAILURE;
+	}
+
+	Checkpoint checkpoint;
+	if(cli.checkpoint_file.presented() && not checkpoint.open(cli.checkpoint_file.value(), NihongoNoSuji::drill_fingerprint(cli))) {
+		fprintf(stderr, "Can not open '%s' : %s\n", cli.checkpoint_file.value().c_str(), checkpoint.error().c_str());
+		return EXIT_FAILURE;
+	}
+
+	if(cli.replay_file.presented()) {
+		SessionReplay replay;
+		if(not replay.load(cli.replay_file.value().c_str())) {
+			fprintf(stderr, "Can not load '%s' : %s\n", cli.replay_file.value().c_str(), replay.error().c_str());
+			return EXIT_FAILURE;
+		}
+
+		const std::string drill = NihongoNoSuji::drill_options(cli);
+		if(replay.drill() != drill) {
+			fprintf(stderr, "Can not replay '%s' : it is recorded with the options\n\t%s\nnot with\n\t%s\n",
+				cli.replay_file.value().c_str(), replay.drill().c_str(), drill.c_str());
+			return EXIT_FAILURE;
+		}
+
+		NihongoNoSuji app(cli, replay, replay.seed());
+		app.set_words(lex, words);
+		const auto tm_before = std::chrono::steady_clock::now();
+		app.run();
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - tm_before;
+
+		const bool result = replay.verify();
+		printf("Replay : %s. %u rounds in %.6f seconds (%.0f rounds/s).\n",
+			result ? "identical" : replay.error().c_str(), replay.rounds(), elapsed.count(), replay.rounds() / elapsed.count());
+		return result ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	FILE* answers = nullptr;
+	if(cli.script.value() == NihongoNoSujiCli::EnumScript::FILE) {
+		answers = fopen(cli.script_file.value().c_str(), "r");
+		if(answers == nullptr) {
+			fprintf(stderr, "Can not open '%s'\n", cli.script_file.value().c_str());
+			return EXIT_FAILURE;
+		}
+	}
+
+	// The record replays from the seed, not from the middle of a session.
+	if(cli.record_file.presented() && checkpoint.resumed()) {
+		fprintf(stderr, "Can not record a session resumed from '%s', complete it or remove the checkpoint first.\n",
+			cli.checkpoint_file.value().c_str());
+		return EXIT_FAILURE;
+	}
+
+	FILE* record = nullptr;
+	if(cli.record_file.presented()) {
+		record = fopen(cli.record_file.value().c_str(), "w");
+		if(record == nullptr) {
+			fprintf(stderr, "Can not open '%s'\n", cli.record_file.value().c_str());
+			return EXIT_FAILURE;
+		}
+	}
+
+	ScriptConsole script(static_cast<ScriptConsole::Policy>(cli.script.value().get()), cli.script_error, answers, seed + 1u);
+	Console& user = cli.script.presented() ? static_cast<Console&>(script) : con;
+
+	std::chrono::duration<double> elapsed{};
+	unsigned mistakes = 0;
+	{
+		std::optional<SessionRecorder> recorder;
+		if(record != nullptr) {
+			recorder.emplace(user, record, seed, NihongoNoSuji::drill_options(cli));
+		}
+
+		NihongoNoSuji app(cli, recorder ? *recorder : user, seed);
+		app.set_words(lex, words);
+		if(cli.progress_file.presented()) {
+			app.set_progress(progress);
+		}
+		if(cli.checkpoint_file.presented()) {
+			app.set_checkpoint(checkpoint);
+		}
+		const auto tm_before = std::chrono::steady_clock::now();
+		app.run();
+		elapsed = std::chrono::steady_clock::now() - tm_before;
+		mistakes = app.mistakes();
+	}
+
+	if(record != nullptr) {
+		fclose(record);
+	}
+	if(answers != nullptr) {
+		fclose(answers);
+	}
+
+	if(cli.script.presented()) {
+		printf("Script : %" PRIu64 " rounds, %" PRIu64 " answers, %u mistakes, %" PRIu64 " bytes in %.6f seconds (%.0f rounds/s).\n",
+			script.rounds(), script.answers(), mistakes, script.bytes(), elapsed.count(), script.rounds() / elapsed.count());
+	}
 
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,332 @@
+#include "nihongo.h"
+
+#include "DiceMachine.h"
+#include "FuzzyMatcher.h"
+#include "Lexicon.h"
+#include "Number.h"
+#include "NumberRenderer.h"
+#include "Questions.h"
+#include "ReadingLattice.h"
+#include "Romaji.h"
+#include "Utf8.h"
+
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct nns_lexicon {
+	Lexicon lex;
+};
+
+namespace {
+
+constexpr unsigned NUMBER_MAX_WIDTH = 12u;
+
+/**
+ * No exception leaves the library, the only one thrown is bad_alloc.
+ */
+template <typename F>
+auto guarded(F&& fn) -> decltype(fn()) {
+	try {
+		return fn();
+	} catch(const std::bad_alloc&) {
+		return NNS_ERROR_MEMORY;
+	}
+}
+
+int copy_out(const std::string_view& text, char* buf, const size_t size, size_t* len) {
+	if(len != nullptr) {
+		*len = text.size();
+	}
+	if(text.size() > size || (buf == nullptr && not text.empty())) {
+		return NNS_ERROR_SPACE;
+	}
+	if(not text.empty()) {
+		memcpy(buf, text.data(), text.size());
+	}
+	return NNS_OK;
+}
+
+bool valid_number(const uint64_t value, const unsigned width, const nns_reading reading) {
+	const unsigned max_width = reading == NNS_READING_NUMBER ? NUMBER_MAX_WIDTH : Number::MAX_WIDTH;
+	return width > 0 && width <= max_width && (width == Number::MAX_WIDTH || value < Number::POW10[width]);
+}
+
+bool valid_time(const unsigned hours, const unsigned minutes) {
+	return hours < 24u && minutes < 60u;
+}
+
+/**
+ * The answer without the spaces, transliterated if it is in romaji.
+ */
+std::string normalize(const char* text, const size_t text_len, const nns_answer answer) {
+	std::string result;
+	result.reserve(text_len);
+	for(size_t i = 0; i < text_len; ++i) {
+		if(text[i] != ' ' && text[i] != '\t' && text[i] != '\r' && text[i] != '\n') {
+			result.push_back(text[i]);
+		}
+	}
+	if(answer == NNS_ANSWER_ROMAJI) {
+		std::string kana;
+		Romaji::to_hiragana(result, kana);
+		result.swap(kana);
+	}
+	return result;
+}
+
+} // namespace
+
+extern "C" {
+
+int nns_api_version(void) {
+	return NNS_API_VERSION;
+}
+
+void nns_rng_seed(nns_rng* rng, const uint64_t seed) {
+	if(rng == nullptr) {
+		return;
+	}
+	rng->state = DiceMachine(seed).state();
+}
+
+uint64_t nns_rng_below(nns_rng* rng, const uint64_t range) {
+	if(rng == nullptr) {
+		return 0;
+	}
+	DiceMachine dm(rng->state);
+	const uint64_t result = dm.below(range);
+	rng->state = dm.state();
+	return result;
+}
+
+int nns_generate_number(nns_rng* rng, const unsigned width_from, const unsigned width_to, uint64_t* value, unsigned* width) {
+	if(rng == nullptr || value == nullptr || width == nullptr) {
+		return NNS_ERROR_ARGUMENT;
+	}
+	if(width_from == 0 || width_from > width_to || width_to > Number::MAX_WIDTH) {
+		return NNS_ERROR_ARGUMENT;
+	}
+	DiceMachine dm(rng->state);
+	const Number number = Questions::number(dm, width_from, width_to);
+	rng->state = dm.state();
+	*value = number.value;
+	*width = number.width;
+	return NNS_OK;
+}
+
+int nns_generate_time(nns_rng* rng, unsigned* hours, unsigned* minutes) {
+	if(rng == nullptr || hours == nullptr || minutes == nullptr) {
+		return NNS_ERROR_ARGUMENT;
+	}
+	DiceMachine dm(rng->state);
+	Questions::time(dm, *hours, *minutes);
+	rng->state = dm.state();
+	return NNS_OK;
+}
+
+int nns_render_number(const uint64_t value, const unsigned width, const nns_reading reading, const nns_script script,
+	char* buf, const size_t size, size_t* len) {
+	if(not valid_number(value, width, reading)) {
+		return NNS_ERROR_ARGUMENT;
+	}
+
+	return guarded([&] {
+		const Number number(value, width);
+		NumberRenderer::String_t text;
+		switch(script) {
+			case NNS_SCRIPT_KANJI:
+				if(reading == NNS_READING_NUMBER) {
+					NumberRenderer::write_number<NumberRenderer::StyleKanji>(number, text);
+				} else {
+					NumberRenderer::write_digits(number, NumberRenderer::DIGIT_MAP_KANJI, text);
+				}
+				break;
+
+			case NNS_SCRIPT_KANA:
+				if(reading == NNS_READING_NUMBER) {
+					NumberRenderer::write_number_hiragana(number, text);
+				} else {
+					NumberRenderer::write_digits(number, NumberRenderer::DIGIT_MAP_HIRAGANA, text);
+				}
+				break;
+
+			case NNS_SCRIPT_ARABIC:
+				NumberRenderer::write_digits(number, NumberRenderer::DIGIT_MAP_ARABIC, text);
+				break;
+
+			default:
+				return int(NNS_ERROR_ARGUMENT);
+		}
+
+		std::string result;
+		Utf8::append(text, result);
+		return copy_out(result, buf, size, len);
+	});
+}
+
+int nns_render_time(const unsigned hours, const unsigned minutes, const nns_script script, char* buf, const size_t size, size_t* len) {
+	if(not valid_time(hours, minutes)) {
+		return NNS_ERROR_ARGUMENT;
+	}
+
+	return guarded([&] {
+		std::string result;
+		switch(script) {
+			case NNS_SCRIPT_KANJI:
+				NumberRenderer::write_time_kanji(hours, minutes, result);
+				break;
+
+			case NNS_SCRIPT_KANA: {
+				ReadingLattice lattice;
+				NumberRenderer::write_time_lattice(hours, minutes, lattice);
+				lattice.write_canonical(result);
+				break;
+			}
+
+			case NNS_SCRIPT_ARABIC:
+				NumberRenderer::write_time_arabic(hours, minutes, result);
+				break;
+
+			default:
+				return int(NNS_ERROR_ARGUMENT);
+		}
+		return copy_out(result, buf, size, len);
+	});
+}
+
+int nns_check_number(const uint64_t value, const unsigned width, const nns_reading reading, const nns_answer answer,
+	const char* text, const size_t text_len) {
+	if(not valid_number(value, width, reading) || (text == nullptr && text_len > 0)) {
+		return NNS_ERROR_ARGUMENT;
+	}
+
+	return guarded([&] {
+		const Number number(value, width);
+		const std::string output = normalize(text, text_len, answer);
+		if(answer == NNS_ANSWER_ARABIC) {
+			return int(number.matches(std::string_view(output)));
+		}
+
+		ReadingLattice lattice;
+		if(reading == NNS_READING_NUMBER) {
+			NumberRenderer::write_number_lattice(number, lattice);
+		} else {
+			NumberRenderer::write_digits_lattice(number, lattice);
+		}
+		return int(lattice.accepts(output));
+	});
+}
+
+int nns_check_time(const unsigned hours, const unsigned minutes, const nns_answer answer, const char* text, const size_t text_len) {
+	if(not valid_time(hours, minutes) || (text == nullptr && text_len > 0)) {
+		return NNS_ERROR_ARGUMENT;
+	}
+
+	return guarded([&] {
+		const std::string output = normalize(text, text_len, answer);
+		if(answer == NNS_ANSWER_ARABIC) {
+			std::string expected;
+			NumberRenderer::write_time_arabic(hours, minutes, expected);
+			return int(output == expected);
+		}
+
+		ReadingLattice lattice;
+		NumberRenderer::write_time_lattice(hours, minutes, lattice);
+		return int(lattice.accepts(output));
+	});
+}
+
+int nns_romaji_to_kana(const char* text, const size_t text_len, char* buf, const size_t size, size_t* len) {
+	if(text == nullptr && text_len > 0) {
+		return NNS_ERROR_ARGUMENT;
+	}
+
+	return guarded([&] {
+		std::string result;
+		Romaji::to_hiragana(std::string_view(text, text_len), result);
+		return copy_out(result, buf, size, len);
+	});
+}
+
+nns_lexicon* nns_lexicon_create(void) {
+	return new(std::nothrow) nns_lexicon();
+}
+
+void nns_lexicon_destroy(nns_lexicon* lex) {
+	delete lex;
+}
+
+int nns_lexicon_add(nns_lexicon* lex, const char* text, const size_t text_len, const char* level) {
+	if(lex == nullptr || (text == nullptr && text_len > 0)) {
+		return NNS_ERROR_ARGUMENT;
+	}
+
+	Lexicon::Tags_t tags = 0;
+	if(level != nullptr) {
+		tags = Lexicon::tag_by_name(level);
+		if((tags & Lexicon::LEVELS) == 0) {
+			return NNS_ERROR_ARGUMENT;
+		}
+	}
+
+	return guarded([&] {
+		return lex->lex.load_text(std::string(text, text_len), tags) ? int(NNS_OK) : int(NNS_ERROR_PARSE);
+	});
+}
+
+size_t nns_lexicon_size(const nns_lexicon* lex) {
+	return lex != nullptr ? lex->lex.size() : 0;
+}
+
+int nns_lexicon_word(const nns_lexicon* lex, const size_t idx, nns_word* word) {
+	if(lex == nullptr || word == nullptr || idx >= lex->lex.size()) {
+		return NNS_ERROR_ARGUMENT;
+	}
+
+	const Lexicon::Entry& entry = lex->lex[idx];
+	word->kanji = entry.kanji.data();
+	word->kanji_len = entry.kanji.size();
+	word->kana = entry.kana.data();
+	word->kana_len = entry.kana.size();
+	word->meaning = entry.meaning.data();
+	word->meaning_len = entry.meaning.size();
+	word->tags = lex->lex.tags(idx);
+	return NNS_OK;
+}
+
+int64_t nns_lexicon_select(const nns_lexicon* lex, const char* filter, uint32_t* idx, const size_t size) {
+	if(lex == nullptr || (idx == nullptr && size > 0)) {
+		return NNS_ERROR_ARGUMENT;
+	}
+
+	Lexicon::Filter parsed;
+	if(filter != nullptr && not parsed.parse(filter)) {
+		return NNS_ERROR_PARSE;
+	}
+
+	return guarded([&] {
+		Lexicon::Selection words;
+		lex->lex.select(parsed, words);
+		size_t written = 0;
+		words.for_each([idx, size, &written](const size_t word) {
+			if(written < size) {
+				idx[written++] = uint32_t(word);
+			}
+		});
+		return int64_t(words.count());
+	});
+}
+
+int nns_check_meaning(const nns_lexicon* lex, const size_t idx, const char* text, const size_t text_len, const double fuzzy) {
+	if(lex == nullptr || idx >= lex->lex.size() || (text == nullptr && text_len > 0) || fuzzy < 0 || fuzzy >= 1) {
+		return NNS_ERROR_ARGUMENT;
+	}
+	return guarded([&] {
+		return int(FuzzyMatcher::matches(lex->lex[idx].meaning, std::string_view(text, text_len), fuzzy));
+	});
+}
+
+} // extern "C"
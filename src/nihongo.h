@@ -0,0 +1,140 @@
+#ifndef NIHONGO_H
+#define NIHONGO_H
+
+/**
+ * libnihongo : the renderers, the random questions, the dictionaries and the answer checks
+ * of nihongo_no_suji for in-process use.
+ *
+ * The strings are UTF-8 with explicit lengths. A function writing text takes a caller-owned
+ * buffer and its size, stores the length of the full text into *len and fails with
+ * NNS_ERROR_SPACE if the buffer is too small, the text is not terminated by zero.
+ * The library writes nothing to the standard streams and has no mutable global state,
+ * so the calls on distinct objects are thread safe.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define NNS_API __attribute__((visibility("default")))
+#else
+#define NNS_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NNS_API_VERSION 1
+
+enum {
+	NNS_OK = 0,
+	NNS_ERROR_ARGUMENT = -1,
+	NNS_ERROR_SPACE = -2,
+	NNS_ERROR_PARSE = -3,
+	NNS_ERROR_MEMORY = -4
+};
+
+typedef enum nns_script {
+	NNS_SCRIPT_KANJI = 0,
+	NNS_SCRIPT_KANA = 1,
+	NNS_SCRIPT_ARABIC = 2
+} nns_script;
+
+/** A number is read as a whole (千二百) or digit by digit (一二00). */
+typedef enum nns_reading {
+	NNS_READING_NUMBER = 0,
+	NNS_READING_DIGITS = 1
+} nns_reading;
+
+/** A kana answer accepts all the common readings, a romaji one is transliterated first. */
+typedef enum nns_answer {
+	NNS_ANSWER_ARABIC = 0,
+	NNS_ANSWER_KANA = 1,
+	NNS_ANSWER_ROMAJI = 2
+} nns_answer;
+
+/** The state of a random stream, owned by the caller. */
+typedef struct nns_rng {
+	uint64_t state;
+} nns_rng;
+
+/** A word of a lexicon, the views live as long as the lexicon. */
+typedef struct nns_word {
+	const char* kanji;
+	size_t kanji_len;
+	const char* kana;
+	size_t kana_len;
+	const char* meaning;
+	size_t meaning_len;
+	uint32_t tags;
+} nns_word;
+
+typedef struct nns_lexicon nns_lexicon;
+
+NNS_API int nns_api_version(void);
+
+/** A NULL @rng is ignored. */
+NNS_API void nns_rng_seed(nns_rng* rng, uint64_t seed);
+
+/** @return A number in [0, range), 0 for a NULL @rng. */
+NNS_API uint64_t nns_rng_below(nns_rng* rng, uint64_t range);
+
+/**
+ * A random number of @width_from ... @width_to digits (1 ... 19), as the drills ask it.
+ */
+NNS_API int nns_generate_number(nns_rng* rng, unsigned width_from, unsigned width_to, uint64_t* value, unsigned* width);
+
+NNS_API int nns_generate_time(nns_rng* rng, unsigned* hours, unsigned* minutes);
+
+/**
+ * Renders @value of @width digits, the leading zeros are kept when read digit by digit.
+ * The whole reading is limited to 12 digits, 9999億.
+ */
+NNS_API int nns_render_number(uint64_t value, unsigned width, nns_reading reading, nns_script script,
+	char* buf, size_t size, size_t* len);
+
+NNS_API int nns_render_time(unsigned hours, unsigned minutes, nns_script script, char* buf, size_t size, size_t* len);
+
+/**
+ * Checks an answer, the spaces are ignored.
+ * @return 1 if correct, 0 if wrong or a negative error.
+ */
+NNS_API int nns_check_number(uint64_t value, unsigned width, nns_reading reading, nns_answer answer,
+	const char* text, size_t text_len);
+
+NNS_API int nns_check_time(unsigned hours, unsigned minutes, nns_answer answer, const char* text, size_t text_len);
+
+NNS_API int nns_romaji_to_kana(const char* text, size_t text_len, char* buf, size_t size, size_t* len);
+
+NNS_API nns_lexicon* nns_lexicon_create(void);
+
+NNS_API void nns_lexicon_destroy(nns_lexicon* lex);
+
+/**
+ * Merges a dictionary in the text format of the .dic files, the text is copied.
+ * @level is "n5" ... "n1" or NULL.
+ */
+NNS_API int nns_lexicon_add(nns_lexicon* lex, const char* text, size_t text_len, const char* level);
+
+NNS_API size_t nns_lexicon_size(const nns_lexicon* lex);
+
+NNS_API int nns_lexicon_word(const nns_lexicon* lex, size_t idx, nns_word* word);
+
+/**
+ * Selects the words by a filter ("n5,verb,-mastered"), writes up to @size indexes.
+ * @return The number of the selected words or a negative error.
+ */
+NNS_API int64_t nns_lexicon_select(const nns_lexicon* lex, const char* filter, uint32_t* idx, size_t size);
+
+/**
+ * Checks a meaning within @fuzzy typos per character of a gloss.
+ * @return 1 if correct, 0 if wrong or a negative error.
+ */
+NNS_API int nns_check_meaning(const nns_lexicon* lex, size_t idx, const char* text, size_t text_len, double fuzzy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif